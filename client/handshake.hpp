@@ -0,0 +1,58 @@
+#pragma once
+
+#include <boost/beast/core.hpp>            // 引入 Boost.Beast 核心库
+#include <boost/beast/websocket.hpp>       // 引入 WebSocket 支持
+#include <boost/asio/connect.hpp>         // 引入 Boost.Asio 连接功能
+#include <boost/asio/ip/tcp.hpp>          // 引入 Boost.Asio TCP 支持
+#include <string>                          // std::string 类型
+#include <utility>                         // std::move、std::forward
+
+// 客户端的连接与 WebSocket 握手，交互式客户端（阻塞）与压测工具（异步）共用
+namespace handshake {
+
+namespace beast = boost::beast;
+namespace websocket = beast::websocket;
+namespace net = boost::asio;
+using tcp = boost::asio::ip::tcp;
+
+// 握手请求的目标路径
+constexpr char const* target = "/";
+
+// 在握手请求中提出 permessage-deflate：服务端接受时 Beast 自动解压收到的压缩消息，
+// 客户端发出的消息也按协商结果压缩；不要求服务端保留压缩上下文，服务端也不必为本连接保留解压窗口
+template<class NextLayer>
+void enable_deflate(websocket::stream<NextLayer>& ws) {
+    websocket::permessage_deflate pmd;
+    pmd.client_enable = true;
+    pmd.server_no_context_takeover = true;
+    pmd.client_no_context_takeover = true;
+    ws.set_option(pmd);
+}
+
+// 阻塞方式：连接到 results 中第一个可用的地址，并以 host 为 Host 字段完成握手
+template<class NextLayer>
+void connect(websocket::stream<NextLayer>& ws,
+             tcp::resolver::results_type const& results,
+             std::string const& host) {
+    net::connect(beast::get_lowest_layer(ws), results.begin(), results.end());
+    ws.handshake(host, target);
+}
+
+// 异步方式：连接到 endpoint 并完成握手，handler 签名为 void(error_code)
+// ws 需在操作完成前保持有效
+template<class NextLayer, class Handler>
+void async_connect(websocket::stream<NextLayer>& ws,
+                   tcp::endpoint const& endpoint,
+                   std::string const& host,
+                   Handler&& handler) {
+    beast::get_lowest_layer(ws).async_connect(
+        endpoint,
+        [&ws, host, handler = std::forward<Handler>(handler)](beast::error_code ec) mutable {
+            if(ec) {
+                return handler(ec);
+            }
+            ws.async_handshake(host, target, std::move(handler));
+        });
+}
+
+} // namespace handshake
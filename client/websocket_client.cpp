@@ -2,7 +2,6 @@
 
 #include <boost/beast/core.hpp>            // 引入 Boost.Beast 核心库
 #include <boost/beast/websocket.hpp>       // 引入 WebSocket 支持
-#include <boost/asio/connect.hpp>         // 引入 Boost.Asio 连接功能
 #include <boost/asio/ip/tcp.hpp>          // 引入 Boost.Asio TCP 支持
 #include <cstdlib>                         // 引入 EXIT_SUCCESS、EXIT_FAILURE 等
 #include <iostream>                        // 标准输入输出流
@@ -10,6 +9,7 @@
 #include <thread>                          // 多线程支持
 #include <atomic>                          // 原子操作支持
 #include <mutex>                           // 互斥量支持
+#include "handshake.hpp"                   // 连接与握手，与压测工具共用
 
 // 为不同模块定义简短别名，减少代码冗余
 namespace beast = boost::beast;
@@ -43,11 +43,9 @@ public:
         tcp::resolver resolver(ioc_);
         auto const results = resolver.resolve(host_, port_);
         
-        // 连接到第一个可用的 endpoint
-        net::connect(ws_.next_layer(), results.begin(), results.end());
-        
-        // 完成 WebSocket 握手，路径为 '/'
-        ws_.handshake(host_, "/");
+        // 连接到第一个可用的 endpoint 并完成 WebSocket 握手，路径为 '/'，同时请求压缩扩展
+        handshake::enable_deflate(ws_);
+        handshake::connect(ws_, results, host_);
         
         // 输出连接成功信息（加锁以避免并发输出混乱）
         {
@@ -0,0 +1,538 @@
+// WebSocket 压测工具：在一个进程中建立大量异步连接，按固定速率发布消息并测量投递延迟
+//
+// - 每个线程一个 io_context，连接平均分到各个线程，只在所属线程上读写
+// - 前 --publishers 个连接按计划时刻发布消息，总速率为 --rate 条/秒；
+//   负载中嵌入计划发送时刻与实际发送时刻，所有连接（包括发布者）读取转发来的消息并计算延迟
+// - 协调遗漏（coordinated omission）修正：计划时刻按固定间隔推进，与实际何时发出无关；
+//   发送被阻塞时积压的消息仍按各自的计划时刻计算延迟，因此服务器卡顿会如实反映在高分位上。
+//   同时输出未修正（从实际发送时刻起算）的分位数以便对比
+// - 结果以 JSON 输出到标准输出，进度与摘要输出到标准错误
+//
+// 用法: websocket_loadgen <host> <port> [--名称=值 ...]，选项见 usage()
+
+#define BOOST_BEAST_USE_STD_STRING_VIEW  // 使用标准库的 std::string_view，方便 Beast 库使用
+
+#include <boost/beast/core.hpp>            // 引入 Boost.Beast 核心库
+#include <boost/beast/websocket.hpp>       // 引入 WebSocket 支持
+#include <boost/asio/ip/tcp.hpp>          // 引入 Boost.Asio TCP 支持
+#include <boost/asio/post.hpp>            // 向各线程投递任务
+#include <boost/asio/steady_timer.hpp>    // 发布计时
+#include <sys/resource.h>                  // 提高文件描述符上限
+#include <algorithm>                       // std::max、std::min
+#include <array>                           // 直方图桶
+#include <atomic>                          // 原子操作支持
+#include <chrono>                          // 计时
+#include <cstdint>                         // 定长整数类型
+#include <cstdio>                          // std::printf
+#include <cstdlib>                         // 引入 EXIT_SUCCESS、EXIT_FAILURE 等
+#include <deque>                           // 待发送消息的计划时刻
+#include <iostream>                        // 标准输入输出流
+#include <memory>                          // 智能指针支持
+#include <stdexcept>                       // std::invalid_argument
+#include <string>                          // std::string 类型
+#include <thread>                          // 多线程支持
+#include <vector>                          // std::vector 容器
+#include "handshake.hpp"                   // 连接与握手，与交互式客户端共用
+
+// 为不同模块定义简短别名，减少代码冗余
+namespace beast = boost::beast;
+namespace websocket = beast::websocket;
+namespace net = boost::asio;
+using tcp = boost::asio::ip::tcp;
+using clock_type = std::chrono::steady_clock;
+
+namespace {
+
+// 压测参数，通过 --名称=值 形式的命令行参数设置
+struct Options {
+    std::string host;                            // 服务器主机地址
+    std::string port;                            // 服务器端口
+    std::size_t connections = 1000;              // 连接总数
+    std::size_t publishers = 10;                 // 发布消息的连接数（取前若干个连接）
+    double rate = 1000;                          // 全部发布者合计的发布速率（条/秒）
+    std::size_t size = 64;                       // 每条消息的负载字节数（至少容纳时间戳）
+    double duration = 10;                        // 发布持续的秒数
+    double drain = 2;                            // 停止发布后继续接收的秒数
+    std::size_t threads = 1;                     // 线程数，每个线程一个 io_context
+    std::size_t concurrency = 256;               // 同时进行中的握手数
+    std::string room;                            // 非空时所有连接先加入该房间
+    bool deflate = false;                        // 握手时请求 permessage-deflate
+};
+
+char const* usage() {
+    return
+        "用法: websocket_loadgen <host> <port> [选项]\n"
+        "  --connections=N  连接总数（默认 1000）\n"
+        "  --publishers=N   发布消息的连接数（默认 10）\n"
+        "  --rate=R         合计发布速率，条/秒（默认 1000）\n"
+        "  --size=N         每条消息的负载字节数（默认 64）\n"
+        "  --duration=S     发布持续的秒数（默认 10）\n"
+        "  --drain=S        停止发布后继续接收的秒数（默认 2）\n"
+        "  --threads=N      线程数（默认 1）\n"
+        "  --concurrency=N  同时进行中的握手数（默认 256）\n"
+        "  --room=NAME      所有连接先加入该房间（默认使用服务器的 lobby）\n"
+        "  --deflate=0|1    握手时请求 permessage-deflate 压缩（默认 0）\n"
+        "示例: websocket_loadgen 127.0.0.1 8080 --connections=20000 --publishers=100 --rate=5000 --threads=4\n"
+        "注意: 单个源地址到同一目标最多约 28000 个连接（受本地端口范围限制）\n";
+}
+
+Options parse_options(int argc, char** argv) {
+    if(argc < 3) {
+        throw std::invalid_argument("缺少 <host> <port>");
+    }
+    Options o;
+    o.host = argv[1];
+    o.port = argv[2];
+    for(int i = 3; i < argc; ++i) {
+        std::string const arg = argv[i];
+        auto const eq = arg.find('=');
+        if(arg.compare(0, 2, "--") != 0 || eq == std::string::npos) {
+            throw std::invalid_argument("无法识别的参数: " + arg);
+        }
+        auto const name = arg.substr(2, eq - 2);
+        auto const value = arg.substr(eq + 1);
+        if(name == "connections") {
+            o.connections = std::stoul(value);
+        } else if(name == "publishers") {
+            o.publishers = std::stoul(value);
+        } else if(name == "rate") {
+            o.rate = std::stod(value);
+        } else if(name == "size") {
+            o.size = std::stoul(value);
+        } else if(name == "duration") {
+            o.duration = std::stod(value);
+        } else if(name == "drain") {
+            o.drain = std::stod(value);
+        } else if(name == "threads") {
+            o.threads = std::max<std::size_t>(1, std::stoul(value));
+        } else if(name == "concurrency") {
+            o.concurrency = std::max<std::size_t>(1, std::stoul(value));
+        } else if(name == "room") {
+            o.room = value;
+        } else if(name == "deflate") {
+            o.deflate = value == "1" || value == "true";
+        } else {
+            throw std::invalid_argument("无法识别的参数: " + arg);
+        }
+    }
+    o.publishers = std::min(o.publishers, o.connections);
+    if(o.publishers == 0 || o.rate <= 0) {
+        throw std::invalid_argument("--publishers 与 --rate 必须大于 0");
+    }
+    return o;
+}
+
+// 纳秒时间戳，同一进程内各线程可比较
+std::int64_t now_ns() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        clock_type::now().time_since_epoch()).count();
+}
+
+// 对数线性分桶的延迟直方图（HDR 风格）：每个 2 的幂区间分为 32 个子桶，相对误差约 3%
+class Histogram {
+    static constexpr unsigned sub_bits = 5;
+    static constexpr std::size_t sub_count = std::size_t(1) << sub_bits;
+    static constexpr std::size_t bucket_count = (64 - sub_bits + 1) * sub_count;
+
+    std::array<std::uint64_t, bucket_count> buckets_{};
+    std::uint64_t count_ = 0;
+    std::uint64_t max_ = 0;
+
+    static std::size_t index(std::uint64_t v) {
+        if(v < sub_count) {
+            return static_cast<std::size_t>(v);
+        }
+        auto const msb = 63u - static_cast<unsigned>(__builtin_clzll(v));
+        auto const shift = msb - sub_bits;
+        return (shift + 1) * sub_count + static_cast<std::size_t>((v >> shift) & (sub_count - 1));
+    }
+
+    static std::uint64_t upper(std::size_t i) {
+        if(i < sub_count) {
+            return i;
+        }
+        auto const shift = i / sub_count - 1;
+        auto const lower = (sub_count + i % sub_count) << shift;
+        return lower + ((std::uint64_t(1) << shift) - 1);
+    }
+
+public:
+    void record(std::int64_t ns) {
+        auto const v = static_cast<std::uint64_t>(std::max<std::int64_t>(ns, 0));
+        ++buckets_[index(v)];
+        ++count_;
+        max_ = std::max(max_, v);
+    }
+
+    void merge(Histogram const& other) {
+        for(std::size_t i = 0; i < bucket_count; ++i) {
+            buckets_[i] += other.buckets_[i];
+        }
+        count_ += other.count_;
+        max_ = std::max(max_, other.max_);
+    }
+
+    std::uint64_t count() const {
+        return count_;
+    }
+
+    // 分位数（微秒），返回所在桶的上界
+    double quantile_us(double q) const {
+        if(count_ == 0) {
+            return 0;
+        }
+        auto const rank = static_cast<std::uint64_t>(q * static_cast<double>(count_ - 1)) + 1;
+        std::uint64_t seen = 0;
+        for(std::size_t i = 0; i < bucket_count; ++i) {
+            seen += buckets_[i];
+            if(seen >= rank) {
+                return static_cast<double>(std::min(upper(i), max_)) / 1000.0;
+            }
+        }
+        return static_cast<double>(max_) / 1000.0;
+    }
+
+    double max_us() const {
+        return static_cast<double>(max_) / 1000.0;
+    }
+};
+
+class Connection;
+
+// 每个线程一份的状态，只在该线程上访问；线程结束后由主线程汇总
+struct Worker {
+    net::io_context ioc{1};                      // 本线程的 I/O 上下文
+    std::vector<std::shared_ptr<Connection>> connections;  // 本线程的全部连接
+    Histogram corrected;                         // 从计划发送时刻起算的延迟
+    Histogram uncorrected;                       // 从实际发送时刻起算的延迟
+    std::uint64_t published = 0;                 // 已发出的消息数
+    std::uint64_t received = 0;                  // 收到的带时间戳消息数
+    std::uint64_t received_bytes = 0;            // 收到的负载字节数
+    std::uint64_t errors = 0;                    // 连接建立后发生的读写错误数
+};
+
+// 所有线程共享的状态
+struct Shared {
+    Options options;                             // 压测参数
+    tcp::endpoint endpoint;                      // 服务器地址
+    std::atomic<std::size_t> next{0};            // 下一个要建立的连接序号
+    std::atomic<std::size_t> connected{0};       // 握手成功的连接数
+    std::atomic<std::size_t> failed{0};          // 握手失败的连接数
+    std::atomic<bool> publishing{false};         // 是否仍在发布
+    clock_type::time_point start;                // 发布开始时刻，开始发布前写入
+};
+
+// 单个压测连接
+class Connection : public std::enable_shared_from_this<Connection> {
+    websocket::stream<beast::tcp_stream> ws_;    // WebSocket 流
+    Worker& worker_;                             // 所属线程
+    Shared& shared_;                             // 共享状态
+    std::size_t index_;                          // 全局连接序号，小于发布者数的连接负责发布
+    beast::flat_buffer buffer_;                  // 读取缓冲区
+    net::steady_timer timer_;                    // 发布计时器
+    clock_type::duration interval_{};            // 两次发布的计划间隔
+    clock_type::time_point next_;                // 下一条消息的计划时刻
+    std::deque<std::int64_t> backlog_;           // 已到计划时刻但尚未发出的消息
+    std::string out_;                            // 正在写入的负载
+    std::string join_;                           // 待发送的加入房间命令
+    bool writing_ = false;                       // 是否有写操作正在进行
+    bool open_ = false;                          // 握手是否已完成且未出错
+
+public:
+    Connection(Worker& worker, Shared& shared, std::size_t index)
+        : ws_(worker.ioc), worker_(worker), shared_(shared), index_(index), timer_(worker.ioc) {}
+
+    // 发起连接与握手，done 在握手结束（无论成败）后调用
+    template<class Done>
+    void start(Done done) {
+        if(shared_.options.deflate) {
+            handshake::enable_deflate(ws_);
+        }
+        handshake::async_connect(
+            ws_, shared_.endpoint, shared_.options.host,
+            [self = shared_from_this(), done](beast::error_code ec) {
+                self->on_handshake(ec);
+                done();
+            });
+    }
+
+    // 在所属线程上开始按计划发布；只对发布者有效
+    void start_publishing() {
+        auto const& o = shared_.options;
+        if(!open_ || index_ >= o.publishers) {
+            return;
+        }
+        // 每个发布者的速率为 rate / publishers，各发布者的相位错开，避免同时发出
+        interval_ = std::chrono::duration_cast<clock_type::duration>(
+            std::chrono::duration<double>(static_cast<double>(o.publishers) / o.rate));
+        next_ = shared_.start + interval_ * static_cast<long>(index_) / static_cast<long>(o.publishers);
+        schedule();
+    }
+
+    // 关闭连接，挂起的操作随之以错误结束
+    void stop() {
+        open_ = false;
+        timer_.cancel();
+        beast::error_code ec;
+        beast::get_lowest_layer(ws_).socket().close(ec);
+    }
+
+private:
+    void on_handshake(beast::error_code ec) {
+        if(ec) {
+            if(shared_.failed.fetch_add(1) == 0) {
+                std::cerr << "握手失败: " << ec.message() << std::endl;
+            }
+            return;
+        }
+        shared_.connected.fetch_add(1);
+        open_ = true;
+        if(!shared_.options.room.empty()) {
+            join_ = "/join " + shared_.options.room;
+            write_next();
+        }
+        read_next();
+    }
+
+    void read_next() {
+        ws_.async_read(
+            buffer_,
+            beast::bind_front_handler(
+                &Connection::on_read,
+                shared_from_this()));
+    }
+
+    void on_read(beast::error_code ec, std::size_t bytes) {
+        if(ec) {
+            if(open_) {
+                ++worker_.errors;
+                open_ = false;
+            }
+            return;
+        }
+
+        // 负载格式: "LG <计划时刻> <实际发送时刻> <填充>"，其他消息（如系统回复）忽略
+        auto const now = now_ns();
+        auto const data = buffer_.cdata();
+        auto const* text = static_cast<char const*>(data.data());
+        if(data.size() > 3 && text[0] == 'L' && text[1] == 'G' && text[2] == ' ') {
+            char* end = nullptr;
+            auto const intended = std::strtoll(text + 3, &end, 10);
+            auto const sent = std::strtoll(end, nullptr, 10);
+            worker_.corrected.record(now - intended);
+            worker_.uncorrected.record(now - sent);
+            ++worker_.received;
+            worker_.received_bytes += bytes;
+        }
+        buffer_.consume(buffer_.size());
+        read_next();
+    }
+
+    // 把所有已到计划时刻的消息加入积压队列，再等待下一条的计划时刻
+    void schedule() {
+        auto const now = clock_type::now();
+        while(next_ <= now) {
+            backlog_.push_back(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                next_.time_since_epoch()).count());
+            next_ += interval_;
+        }
+        write_next();
+
+        if(!shared_.publishing.load(std::memory_order_relaxed) || !open_) {
+            return;
+        }
+        timer_.expires_at(next_);
+        timer_.async_wait([self = shared_from_this()](beast::error_code ec) {
+            if(!ec) {
+                self->schedule();
+            }
+        });
+    }
+
+    // 发出一条积压的消息；同一时刻只有一个写操作
+    void write_next() {
+        if(writing_ || !open_) {
+            return;
+        }
+        if(!join_.empty()) {
+            out_ = std::move(join_);
+            join_.clear();
+        } else if(!backlog_.empty()) {
+            out_ = "LG " + std::to_string(backlog_.front()) + " " + std::to_string(now_ns()) + " ";
+            backlog_.pop_front();
+            if(out_.size() < shared_.options.size) {
+                out_.resize(shared_.options.size, 'x');
+            }
+            ++worker_.published;
+        } else {
+            return;
+        }
+
+        writing_ = true;
+        ws_.async_write(
+            net::buffer(out_),
+            beast::bind_front_handler(
+                &Connection::on_write,
+                shared_from_this()));
+    }
+
+    void on_write(beast::error_code ec, std::size_t) {
+        writing_ = false;
+        if(ec) {
+            if(open_) {
+                ++worker_.errors;
+                open_ = false;
+            }
+            return;
+        }
+        write_next();
+    }
+};
+
+// 在 worker 上建立下一个连接；握手结束后由同一个并发槽位继续，直到达到连接总数
+void connect_next(Worker& worker, Shared& shared) {
+    auto const index = shared.next.fetch_add(1);
+    if(index >= shared.options.connections) {
+        return;
+    }
+    auto conn = std::make_shared<Connection>(worker, shared, index);
+    worker.connections.push_back(conn);
+    conn->start([&worker, &shared] { connect_next(worker, shared); });
+}
+
+// 在每个线程上执行 fn(worker)，并等待全部执行完
+template<class Function>
+void on_each_worker(std::vector<std::unique_ptr<Worker>>& workers, Function fn) {
+    std::atomic<std::size_t> pending{workers.size()};
+    for(auto& w : workers) {
+        net::post(w->ioc, [&pending, &fn, worker = w.get()] {
+            fn(*worker);
+            pending.fetch_sub(1);
+        });
+    }
+    while(pending.load() != 0) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+}
+
+// 尽量提高文件描述符上限，以便建立数万个连接
+void raise_fd_limit() {
+    rlimit limit{};
+    if(getrlimit(RLIMIT_NOFILE, &limit) == 0 && limit.rlim_cur < limit.rlim_max) {
+        limit.rlim_cur = limit.rlim_max;
+        setrlimit(RLIMIT_NOFILE, &limit);
+    }
+}
+
+} // namespace
+
+// 程序入口：建立连接、按计划发布、汇总并输出结果
+int main(int argc, char** argv) {
+    Shared shared;
+    try {
+        shared.options = parse_options(argc, argv);
+        net::io_context resolver_ioc;
+        tcp::resolver resolver(resolver_ioc);
+        shared.endpoint = *resolver.resolve(shared.options.host, shared.options.port).begin();
+    } catch(std::exception const& e) {
+        std::cerr << "错误: " << e.what() << "\n" << usage();
+        return EXIT_FAILURE;
+    }
+    auto const& o = shared.options;
+    raise_fd_limit();
+
+    // 每个线程一个 io_context；work guard 让线程在连接全部关闭前保持运行
+    std::vector<std::unique_ptr<Worker>> workers;
+    std::vector<net::executor_work_guard<net::io_context::executor_type>> guards;
+    for(std::size_t t = 0; t < o.threads; ++t) {
+        workers.push_back(std::make_unique<Worker>());
+        guards.push_back(net::make_work_guard(workers.back()->ioc));
+    }
+    std::vector<std::thread> threads;
+    for(auto& w : workers) {
+        threads.emplace_back([worker = w.get()] { worker->ioc.run(); });
+    }
+
+    // 1. 建立连接：并发槽位平均分给各个线程
+    auto const connect_begin = clock_type::now();
+    for(std::size_t i = 0; i < std::min(o.concurrency, o.connections); ++i) {
+        auto& worker = *workers[i % workers.size()];
+        net::post(worker.ioc, [&worker, &shared] { connect_next(worker, shared); });
+    }
+    while(shared.connected.load() + shared.failed.load() < o.connections) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    auto const connect_seconds = std::chrono::duration<double>(clock_type::now() - connect_begin).count();
+    std::cerr << "已建立连接 " << shared.connected.load() << "，失败 " << shared.failed.load()
+              << "，耗时 " << connect_seconds << " 秒" << std::endl;
+
+    // 加入房间的命令需要先被服务器处理，稍等片刻再开始发布
+    if(!o.room.empty()) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(500));
+    }
+
+    // 2. 按计划发布
+    shared.start = clock_type::now() + std::chrono::milliseconds(50);
+    shared.publishing = true;
+    on_each_worker(workers, [](Worker& w) {
+        for(auto& c : w.connections) {
+            c->start_publishing();
+        }
+    });
+    std::this_thread::sleep_for(std::chrono::duration<double>(o.duration));
+    shared.publishing = false;
+
+    // 3. 停止发布后继续接收转发中的消息，然后关闭全部连接
+    std::this_thread::sleep_for(std::chrono::duration<double>(o.drain));
+    on_each_worker(workers, [](Worker& w) {
+        for(auto& c : w.connections) {
+            c->stop();
+        }
+        w.connections.clear();
+    });
+    guards.clear();
+    for(auto& t : threads) {
+        t.join();
+    }
+
+    // 4. 汇总各线程的结果
+    Worker total;
+    for(auto& w : workers) {
+        total.corrected.merge(w->corrected);
+        total.uncorrected.merge(w->uncorrected);
+        total.published += w->published;
+        total.received += w->received;
+        total.received_bytes += w->received_bytes;
+        total.errors += w->errors;
+    }
+
+    std::vector<std::pair<char const*, double>> const metrics = {
+        {"connect_seconds", connect_seconds},
+        {"connected", static_cast<double>(shared.connected.load())},
+        {"failed", static_cast<double>(shared.failed.load())},
+        {"errors", static_cast<double>(total.errors)},
+        {"published_per_sec", static_cast<double>(total.published) / o.duration},
+        {"delivered_per_sec", static_cast<double>(total.received) / o.duration},
+        {"delivered_mb_per_sec", static_cast<double>(total.received_bytes) / o.duration / 1e6},
+        {"p50_us", total.corrected.quantile_us(0.50)},
+        {"p99_us", total.corrected.quantile_us(0.99)},
+        {"p999_us", total.corrected.quantile_us(0.999)},
+        {"max_us", total.corrected.max_us()},
+        {"uncorrected_p50_us", total.uncorrected.quantile_us(0.50)},
+        {"uncorrected_p99_us", total.uncorrected.quantile_us(0.99)},
+        {"uncorrected_p999_us", total.uncorrected.quantile_us(0.999)},
+    };
+
+    // 与服务端基准相同的 JSON 格式：{"suite": ..., "results": [{"name", "params", "metrics"}]}
+    std::printf("{\n  \"suite\": \"loadgen\",\n  \"results\": [\n");
+    std::printf("    {\"name\": \"loadgen\", \"params\": {\"connections\": \"%zu\", \"publishers\": \"%zu\", "
+                "\"rate\": \"%g\", \"size\": \"%zu\", \"duration\": \"%g\", \"threads\": \"%zu\"}, \"metrics\": {",
+                o.connections, o.publishers, o.rate, o.size, o.duration, o.threads);
+    for(std::size_t i = 0; i < metrics.size(); ++i) {
+        std::printf("%s\"%s\": %.3f", i ? ", " : "", metrics[i].first, metrics[i].second);
+        std::fprintf(stderr, "%s=%.1f%s", metrics[i].first, metrics[i].second,
+                     i + 1 < metrics.size() ? " " : "\n");
+    }
+    std::printf("}}\n  ]\n}\n");
+    return shared.connected.load() > 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,257 @@
+// 处理器内存分配基准：统计服务器线程上每条消息的堆分配次数
+//
+// 在回环地址上建立一条 WebSocket 连接，客户端线程成批发送消息并读回；
+// 服务器线程按 Session 的方式处理每条消息：空缓冲区等待 → 借用帧缓冲区读取负载 → 原地封装 →
+// 放入发送队列并以原始帧写回，写回期间下一次读取已经挂起（与 Session 一样读写操作同时存在）。
+// 分别以默认分配器（处理器不带关联分配器）和会话的 HandlerMemory 运行，
+// 对比稳定状态下每条消息的 operator new 调用次数与耗时。
+// 以 C++20 构建（-DWEBSOCKET_COROUTINES=ON）时再以协程方式（co_await 读取）各运行一次，
+// 与回调链对比。
+//
+// 用法: alloc_bench [消息数] [负载字节数]
+// 结果以 JSON 输出到标准输出
+
+#define BOOST_BEAST_USE_STD_STRING_VIEW
+
+#include "bench.hpp"
+#include "coroutine.hpp"
+#include "frame_buffer.hpp"
+#include "frame_stream.hpp"
+#include "handler_allocator.hpp"
+#include "outbound_queue.hpp"
+
+#include <boost/beast/core.hpp>
+#include <boost/beast/websocket.hpp>
+#include <boost/asio/ip/tcp.hpp>
+#include <cstdlib>                       // std::malloc, std::atoi
+#include <new>                           // 替换全局 operator new
+#include <string>                        // std::string 支持
+#include <thread>                        // 客户端线程
+
+namespace beast = boost::beast;
+namespace websocket = beast::websocket;
+namespace net = boost::asio;
+using tcp = boost::asio::ip::tcp;
+
+namespace {
+
+thread_local std::size_t allocations = 0;     // 本线程调用 operator new 的次数
+
+} // namespace
+
+void* operator new(std::size_t size) {
+    ++allocations;
+    if(void* p = std::malloc(size ? size : 1)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept {
+    std::free(p);
+}
+
+namespace {
+
+constexpr std::size_t batch = 16;             // 客户端每批发送的消息数
+
+// 服务器端的回显会话，Recycle 为 true 时处理器从 HandlerMemory 分配
+// run 以回调链读取，serve 以协程读取；两者的写入相同
+template<bool Recycle>
+class Echo {
+    HandlerMemory memory_;
+    websocket::stream<FrameStream> ws_;
+    boost::intrusive_ptr<FrameBuffer> inbound_;
+    OutboundQueue queue_;
+    QueueLimits const limits_;
+    std::size_t messages_ = 0;                        // 已回显的消息数
+    std::size_t warmup_;                              // 不计入结果的前若干条消息
+    std::size_t start_allocations_ = 0;               // 预热结束时的分配次数
+    bench::clock::time_point start_;                  // 预热结束的时刻
+
+public:
+    std::size_t measured_allocations = 0;             // 预热之后的分配次数
+    double measured_seconds = 0;                      // 预热之后的耗时
+
+    Echo(FrameStream::socket_type socket, std::size_t warmup)
+        : ws_(std::move(socket)), warmup_(warmup) {}
+
+    void run() {
+        ws_.async_accept(wrap([this](beast::error_code ec) {
+            if(!ec) {
+                read();
+            }
+        }));
+    }
+
+#if defined(BOOST_ASIO_HAS_CO_AWAIT)
+    coro::Awaitable<> serve() {
+        beast::error_code ec;
+        co_await ws_.async_accept(token(ec));
+        while(!ec) {
+            auto const n = co_await ws_.async_read_some(read_buffer(), token(ec));
+            if(ec) {
+                finish();
+                break;
+            }
+            received(n);
+        }
+    }
+#endif
+
+    std::size_t messages() const noexcept {
+        return messages_ > warmup_ ? messages_ - warmup_ : 0;
+    }
+
+private:
+    template<class Handler>
+    auto wrap(Handler&& handler) {
+        if constexpr(Recycle) {
+            return bind_memory(memory_, std::forward<Handler>(handler));
+        } else {
+            return std::forward<Handler>(handler);
+        }
+    }
+
+#if defined(BOOST_ASIO_HAS_CO_AWAIT)
+    auto token(beast::error_code& ec) {
+        if constexpr(Recycle) {
+            return coro::use_memory(memory_, ec);
+        } else {
+            return coro::use_default(ec);
+        }
+    }
+#endif
+
+    net::mutable_buffer read_buffer() {
+        static char idle_read;
+        return inbound_ ? inbound_->prepare() : net::mutable_buffer(&idle_read, 0);
+    }
+
+    void read() {
+        ws_.async_read_some(read_buffer(), wrap([this](beast::error_code ec, std::size_t n) {
+            if(ec) {
+                finish();
+                return;
+            }
+            received(n);
+            read();
+        }));
+    }
+
+    // 读到 n 字节负载；消息读完时原地封装并放入发送队列
+    void received(std::size_t n) {
+        if(!inbound_) {
+            inbound_ = FrameBuffer::create();
+        }
+        inbound_->commit(n);
+        if(!ws_.is_message_done()) {
+            return;
+        }
+        inbound_->seal(frame::opcode::binary);
+        queue_.push(std::move(inbound_), limits_);
+        if(!queue_.writing()) {
+            write();
+        }
+    }
+
+    void write() {
+        ws_.next_layer().async_write_frames(
+            queue_.begin_write(256 * 1024),
+            wrap([this](beast::error_code ec, std::size_t) {
+                if(ec) {
+                    queue_.clear();
+                    return;
+                }
+                auto const written = queue_.complete_write();
+                if(messages_ < warmup_ && messages_ + written >= warmup_) {
+                    start_allocations_ = allocations;
+                    start_ = bench::clock::now();
+                }
+                messages_ += written;
+                if(queue_.has_pending()) {
+                    write();
+                }
+            }));
+    }
+
+    void finish() {
+        measured_allocations = allocations - start_allocations_;
+        measured_seconds = bench::seconds_since(start_);
+    }
+};
+
+// 客户端：成批发送 total 条消息，每批发完后读回同样多条
+void run_client(tcp::endpoint endpoint, std::size_t total, std::size_t size) {
+    net::io_context ioc;
+    websocket::stream<tcp::socket> ws(ioc);
+    ws.next_layer().connect(endpoint);
+    ws.next_layer().set_option(tcp::no_delay(true));
+    ws.handshake("localhost", "/");
+    ws.binary(true);
+
+    std::string const payload(size, 'x');
+    beast::flat_buffer buffer;
+    for(std::size_t sent = 0; sent < total; sent += batch) {
+        for(std::size_t i = 0; i < batch; ++i) {
+            ws.write(net::buffer(payload));
+        }
+        for(std::size_t i = 0; i < batch; ++i) {
+            ws.read(buffer);
+            buffer.consume(buffer.size());
+        }
+    }
+    beast::error_code ec;
+    ws.next_layer().close(ec);
+}
+
+template<bool Recycle, bool Coroutine = false>
+void bench_echo(bench::Reporter& reporter, std::size_t total, std::size_t size) {
+    net::io_context ioc(1);
+    tcp::acceptor acceptor(ioc, tcp::endpoint(net::ip::address_v4::loopback(), 0));
+    std::thread client(run_client, acceptor.local_endpoint(), total, size);
+
+    FrameStream::socket_type socket(ioc);
+    acceptor.accept(socket);
+    socket.set_option(tcp::no_delay(true));
+    Echo<Recycle> echo(std::move(socket), total / 10);
+#if defined(BOOST_ASIO_HAS_CO_AWAIT)
+    if constexpr(Coroutine) {
+        net::co_spawn(ioc.get_executor(), echo.serve(), net::detached);
+    } else {
+        echo.run();
+    }
+#else
+    echo.run();
+#endif
+    ioc.run();
+    client.join();
+
+    auto const messages = static_cast<double>(echo.messages());
+    reporter.add({"echo", {{"style", Coroutine ? "coroutine" : "callback"},
+                           {"handlers", Recycle ? "handler_memory" : "default"}, {"size", std::to_string(size)}},
+        {{"allocs_per_message", static_cast<double>(echo.measured_allocations) / messages},
+         {"ns_per_message", echo.measured_seconds * 1e9 / messages}}});
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    std::size_t total = argc > 1 ? std::atoi(argv[1]) : 200000;
+    std::size_t const size = argc > 2 ? std::atoi(argv[2]) : 64;
+    total = (total + batch - 1) / batch * batch;
+
+    bench::Reporter reporter("alloc_bench");
+    bench_echo<false>(reporter, total, size);
+    bench_echo<true>(reporter, total, size);
+#if defined(BOOST_ASIO_HAS_CO_AWAIT)
+    bench_echo<false, true>(reporter, total, size);
+    bench_echo<true, true>(reporter, total, size);
+#endif
+    reporter.print();
+    return 0;
+}
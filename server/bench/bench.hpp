@@ -0,0 +1,75 @@
+#pragma once
+
+#include <chrono>                        // 计时
+#include <cstdio>                        // std::printf
+#include <string>                        // std::string 支持
+#include <utility>                       // std::pair
+#include <vector>                        // std::vector 容器
+
+// 基准测试的公共工具：计时与 JSON 结果输出
+// 所有基准程序都把结果以 JSON 写到标准输出，便于保存后对比不同版本的运行结果
+namespace bench {
+
+using clock = std::chrono::steady_clock;
+
+// 返回从 start 到现在经过的秒数
+inline double seconds_since(clock::time_point start) {
+    return std::chrono::duration<double>(clock::now() - start).count();
+}
+
+// 阻止编译器把基准中的计算结果优化掉
+template<class T>
+inline void do_not_optimize(T const& value) {
+    asm volatile("" : : "r,m"(value) : "memory");
+}
+
+// 一条基准结果：名称、参数和若干指标
+struct Result {
+    std::string name;                                         // 基准名称
+    std::vector<std::pair<std::string, std::string>> params;  // 参数，如实现名、线程数
+    std::vector<std::pair<std::string, double>> metrics;      // 指标，如 ns/op、ops/s
+};
+
+// 收集结果并在结束时输出一个 JSON 文档
+class Reporter {
+    std::string suite_;                               // 基准套件名称
+    std::vector<Result> results_;                     // 已收集的结果
+
+public:
+    explicit Reporter(std::string suite) : suite_(std::move(suite)) {}
+
+    void add(Result result) {
+        // 同时在标准错误输出一行进度，方便交互运行时观察
+        std::fprintf(stderr, "%s", result.name.c_str());
+        for(auto const& p : result.params) {
+            std::fprintf(stderr, " %s=%s", p.first.c_str(), p.second.c_str());
+        }
+        for(auto const& m : result.metrics) {
+            std::fprintf(stderr, " %s=%.1f", m.first.c_str(), m.second);
+        }
+        std::fprintf(stderr, "\n");
+        results_.push_back(std::move(result));
+    }
+
+    // 输出格式：{"suite": ..., "results": [{"name": ..., "params": {...}, "metrics": {...}}]}
+    void print() const {
+        std::printf("{\n  \"suite\": \"%s\",\n  \"results\": [\n", suite_.c_str());
+        for(std::size_t i = 0; i < results_.size(); ++i) {
+            auto const& r = results_[i];
+            std::printf("    {\"name\": \"%s\", \"params\": {", r.name.c_str());
+            for(std::size_t j = 0; j < r.params.size(); ++j) {
+                std::printf("%s\"%s\": \"%s\"", j ? ", " : "",
+                    r.params[j].first.c_str(), r.params[j].second.c_str());
+            }
+            std::printf("}, \"metrics\": {");
+            for(std::size_t j = 0; j < r.metrics.size(); ++j) {
+                std::printf("%s\"%s\": %.3f", j ? ", " : "",
+                    r.metrics[j].first.c_str(), r.metrics[j].second);
+            }
+            std::printf("}}%s\n", i + 1 < results_.size() ? "," : "");
+        }
+        std::printf("  ]\n}\n");
+    }
+};
+
+} // namespace bench
@@ -0,0 +1,165 @@
+// 连接风暴基准：模拟部署后大量客户端同时重连
+//
+// 以固定并发度向服务器发起 TCP 连接并完成 WebSocket 握手，
+// 统计每秒完成的握手数以及从发起连接到握手完成的延迟分布。
+// 所有连接在测量结束后才统一关闭，以免断开干扰接受路径。
+//
+// 用法: connect_storm <host> <port> [连接总数] [并发度] [线程数]
+// 对比不同接受模式时分别以 --reuseport=0 / --reuseport=1 启动服务器
+// 结果以 JSON 输出到标准输出
+
+#define BOOST_BEAST_USE_STD_STRING_VIEW
+
+#include "bench.hpp"
+
+#include <boost/beast/core.hpp>
+#include <boost/beast/websocket.hpp>
+#include <boost/asio/ip/tcp.hpp>
+#include <algorithm>                     // std::sort
+#include <atomic>                        // 原子计数
+#include <cstdlib>                       // std::atoi
+#include <iostream>                      // 标准输入输出流
+#include <memory>                        // 智能指针支持
+#include <mutex>                         // 互斥量支持
+#include <string>                        // std::string 支持
+#include <thread>                        // 多线程支持
+#include <vector>                        // std::vector 容器
+
+namespace beast = boost::beast;
+namespace websocket = beast::websocket;
+namespace net = boost::asio;
+using tcp = boost::asio::ip::tcp;
+
+namespace {
+
+// 所有连接共享的状态
+struct Storm {
+    std::string host;                                 // 握手时的 Host 字段
+    tcp::endpoint endpoint;                           // 服务器地址
+    std::size_t total = 0;                            // 需要建立的连接总数
+    std::atomic<std::size_t> started{0};              // 已发起的连接数
+    std::atomic<std::size_t> finished{0};             // 已结束（成功或失败）的连接数
+    std::atomic<std::size_t> failed{0};               // 失败的连接数
+    std::mutex mutex;                                 // 保护下面两个容器
+    std::vector<double> latencies_us;                 // 每个成功握手的延迟（微秒）
+    std::vector<std::shared_ptr<websocket::stream<beast::tcp_stream>>> streams;  // 保持已建立的连接
+};
+
+// 发起一个连接；完成后由同一个“并发槽位”继续发起下一个，直到达到总数
+void start_one(net::io_context& ioc, Storm& storm) {
+    if(storm.started.fetch_add(1) >= storm.total) {
+        return;
+    }
+
+    auto ws = std::make_shared<websocket::stream<beast::tcp_stream>>(ioc);
+    auto const begin = bench::clock::now();
+
+    auto fail = [&ioc, &storm](beast::error_code const& ec) {
+        if(storm.failed.fetch_add(1) == 0) {
+            std::cerr << "连接失败: " << ec.message() << std::endl;
+        }
+        storm.finished.fetch_add(1);
+        start_one(ioc, storm);
+    };
+
+    beast::get_lowest_layer(*ws).async_connect(
+        storm.endpoint,
+        [&ioc, &storm, ws, begin, fail](beast::error_code ec) {
+            if(ec) {
+                return fail(ec);
+            }
+            ws->async_handshake(
+                storm.host, "/",
+                [&ioc, &storm, ws, begin, fail](beast::error_code ec) {
+                    if(ec) {
+                        return fail(ec);
+                    }
+                    auto const us = std::chrono::duration<double, std::micro>(
+                        bench::clock::now() - begin).count();
+                    {
+                        std::lock_guard<std::mutex> lock(storm.mutex);
+                        storm.latencies_us.push_back(us);
+                        storm.streams.push_back(ws);
+                    }
+                    storm.finished.fetch_add(1);
+                    start_one(ioc, storm);
+                });
+        });
+}
+
+// 取已排序样本的分位数
+double percentile(std::vector<double> const& sorted, double p) {
+    if(sorted.empty()) {
+        return 0;
+    }
+    auto const index = static_cast<std::size_t>(p * (sorted.size() - 1));
+    return sorted[index];
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    if(argc < 3) {
+        std::cerr << "用法: " << argv[0] << " <host> <port> [连接总数] [并发度] [线程数]\n";
+        std::cerr << "示例: " << argv[0] << " 127.0.0.1 8080 10000 512 2\n";
+        return EXIT_FAILURE;
+    }
+
+    Storm storm;
+    storm.host = argv[1];
+    storm.total = argc > 3 ? std::atoi(argv[3]) : 10000;
+    std::size_t const concurrency = argc > 4 ? std::atoi(argv[4]) : 512;
+    unsigned const threads = argc > 5 ? std::atoi(argv[5]) : 1;
+
+    try {
+        net::io_context resolver_ioc;
+        tcp::resolver resolver(resolver_ioc);
+        storm.endpoint = *resolver.resolve(argv[1], argv[2]).begin();
+    } catch(std::exception const& e) {
+        std::cerr << "错误: " << e.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+    storm.latencies_us.reserve(storm.total);
+    storm.streams.reserve(storm.total);
+
+    // 每个线程一个 io_context，并发槽位平均分给各个线程
+    std::vector<std::unique_ptr<net::io_context>> contexts;
+    for(unsigned t = 0; t < std::max(threads, 1u); ++t) {
+        contexts.push_back(std::make_unique<net::io_context>(1));
+    }
+    for(std::size_t i = 0; i < concurrency; ++i) {
+        auto& ioc = *contexts[i % contexts.size()];
+        net::post(ioc, [&ioc, &storm] { start_one(ioc, storm); });
+    }
+
+    auto const begin = bench::clock::now();
+    std::vector<std::thread> workers;
+    for(auto& ioc : contexts) {
+        workers.emplace_back([&ioc] { ioc->run(); });
+    }
+    for(auto& w : workers) {
+        w.join();
+    }
+    auto const elapsed = bench::seconds_since(begin);
+
+    // 握手全部结束后再统一关闭连接
+    storm.streams.clear();
+
+    auto& samples = storm.latencies_us;
+    std::sort(samples.begin(), samples.end());
+
+    bench::Reporter reporter("connect_storm");
+    bench::Result result{"connect_storm", {
+        {"connections", std::to_string(storm.total)},
+        {"concurrency", std::to_string(concurrency)},
+        {"threads", std::to_string(contexts.size())}}, {}};
+    result.metrics.emplace_back("handshakes_per_sec", samples.size() / elapsed);
+    result.metrics.emplace_back("failed", static_cast<double>(storm.failed.load()));
+    result.metrics.emplace_back("p50_us", percentile(samples, 0.50));
+    result.metrics.emplace_back("p99_us", percentile(samples, 0.99));
+    result.metrics.emplace_back("p999_us", percentile(samples, 0.999));
+    result.metrics.emplace_back("max_us", samples.empty() ? 0 : samples.back());
+    reporter.add(std::move(result));
+    reporter.print();
+    return EXIT_SUCCESS;
+}
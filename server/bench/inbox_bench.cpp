@@ -0,0 +1,140 @@
+// 跨线程投递的竞争基准：多个生产者线程向一个事件循环投递消息
+//
+// 对比两种投递方式：
+//   post   每条消息各 post 一个任务（改动之前 FanOut 的做法）
+//   inbox  放入无锁 MPSC 收件箱，只有放入空收件箱的生产者 post 一次，事件循环一次取走整批
+//
+// 每条消息携带一个共享帧，与广播时传递的内容相同。生产者共发送固定条数，
+// 计时从生产者开始到事件循环处理完最后一条为止。
+//
+// 用法: inbox_bench [每轮总消息数]
+// 结果以 JSON 输出到标准输出
+
+#include "bench.hpp"
+#include "frame_buffer.hpp"
+#include "mpsc_inbox.hpp"
+
+#include <boost/asio/executor_work_guard.hpp>  // 让事件循环在空闲时继续运行
+#include <boost/asio/io_context.hpp>     // 消费者事件循环
+#include <boost/asio/post.hpp>           // 投递任务
+#include <atomic>                        // 原子变量
+#include <cstdint>                       // 定长整数类型
+#include <cstdlib>                       // std::atoi
+#include <string>                        // std::string 支持
+#include <thread>                        // 多线程支持
+#include <vector>                        // std::vector 容器
+
+namespace {
+
+namespace net = boost::asio;
+
+// 一条投递
+struct Item {
+    FrameRef frame;
+    std::uint64_t seq;
+};
+
+// 消费者一侧的统计，只在事件循环线程上写入
+struct Consumer {
+    std::uint64_t received = 0;                       // 已处理的消息数
+    std::uint64_t wakeups = 0;                        // 被唤醒（执行任务）的次数
+    std::uint64_t checksum = 0;                       // 防止处理过程被优化掉
+    std::atomic<bool> done{false};                    // 已处理完全部消息
+
+    void consume(Item const& item, std::uint64_t expected) {
+        checksum += item.seq + item.frame->size();
+        if(++received == expected) {
+            done.store(true, std::memory_order_release);
+        }
+    }
+};
+
+// 启动 producers 个生产者线程，每个调用 send(item) 共 per_producer 次，等待消费者处理完
+template<class Send>
+double run(net::io_context& ioc, Consumer& consumer, unsigned producers,
+           std::uint64_t per_producer, Send send) {
+    auto guard = net::make_work_guard(ioc);
+    std::thread loop([&] { ioc.run(); });
+
+    auto const frame = FrameBuffer::make(frame::opcode::text, std::string(64, 'x'));
+    std::atomic<bool> go{false};
+    std::vector<std::thread> workers;
+    for(unsigned p = 0; p < producers; ++p) {
+        workers.emplace_back([&, p] {
+            while(!go.load(std::memory_order_acquire)) {
+            }
+            for(std::uint64_t i = 0; i < per_producer; ++i) {
+                send(Item{frame, p * per_producer + i});
+            }
+        });
+    }
+
+    auto const start = bench::clock::now();
+    go.store(true, std::memory_order_release);
+    for(auto& w : workers) {
+        w.join();
+    }
+    while(!consumer.done.load(std::memory_order_acquire)) {
+        std::this_thread::yield();
+    }
+    auto const elapsed = bench::seconds_since(start);
+
+    guard.reset();
+    ioc.stop();
+    loop.join();
+    return elapsed;
+}
+
+void report(bench::Reporter& reporter, char const* impl, unsigned producers,
+            std::uint64_t total, double elapsed, Consumer const& consumer) {
+    bench::do_not_optimize(consumer.checksum);
+    reporter.add({"handoff", {{"impl", impl}, {"producers", std::to_string(producers)}},
+        {{"msgs_per_sec", total / elapsed},
+         {"ns_per_msg", elapsed * 1e9 / total},
+         {"wakeups_per_1k_msgs", consumer.wakeups * 1000.0 / total},
+         {"msgs_per_wakeup", consumer.wakeups ? static_cast<double>(consumer.received) / consumer.wakeups : 0}}});
+}
+
+void bench_post(bench::Reporter& reporter, unsigned producers, std::uint64_t per_producer) {
+    net::io_context ioc(1);
+    Consumer consumer;
+    auto const total = per_producer * producers;
+    auto const elapsed = run(ioc, consumer, producers, per_producer, [&](Item item) {
+        net::post(ioc, [&consumer, total, item = std::move(item)] {
+            ++consumer.wakeups;
+            consumer.consume(item, total);
+        });
+    });
+    report(reporter, "post", producers, total, elapsed, consumer);
+}
+
+void bench_inbox(bench::Reporter& reporter, unsigned producers, std::uint64_t per_producer) {
+    net::io_context ioc(1);
+    Consumer consumer;
+    MpscInbox<Item> inbox;
+    auto const total = per_producer * producers;
+    auto const elapsed = run(ioc, consumer, producers, per_producer, [&](Item item) {
+        if(inbox.push(std::move(item))) {
+            net::post(ioc, [&consumer, &inbox, total] {
+                ++consumer.wakeups;
+                inbox.drain([&](Item const& i) { consumer.consume(i, total); });
+            });
+        }
+    });
+    report(reporter, "inbox", producers, total, elapsed, consumer);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    std::uint64_t const total = argc > 1 ? std::atoi(argv[1]) : 2000000;
+
+    bench::Reporter reporter("inbox");
+    for(unsigned producers : {1u, 2u, 4u, 8u}) {
+        auto const per_producer = total / producers;
+        bench_post(reporter, producers, per_producer);
+        bench_inbox(reporter, producers, per_producer);
+    }
+    reporter.print();
+    return EXIT_SUCCESS;
+}
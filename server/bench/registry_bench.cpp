@@ -0,0 +1,203 @@
+// 会话注册表竞争基准：对比旧的 std::set + 单个互斥量与分片注册表
+//
+// 场景：
+//   connect_disconnect  每个线程反复登记并注销自己的会话
+//   broadcast           每个线程反复遍历全部会话（模拟广播）
+//   mixed               一个线程做连接/断开，其余线程同时广播
+//
+// 用法: registry_bench [预置会话数] [每个场景的秒数]
+// 结果以 JSON 输出到标准输出
+
+#include "bench.hpp"
+#include "session_registry.hpp"
+
+#include <atomic>                        // 原子变量
+#include <cstdlib>                       // std::atoi、std::atof
+#include <memory>                        // 智能指针支持
+#include <mutex>                         // 互斥量支持
+#include <set>                           // std::set 容器
+#include <string>                        // std::string 支持
+#include <thread>                        // 多线程支持
+#include <vector>                        // std::vector 容器
+
+namespace {
+
+// 基准用的假会话，只携带注册表挂钩和一个用于遍历时读取的字段
+struct FakeSession {
+    RegistryHook hook;
+    std::uint64_t id = 0;
+
+    RegistryHook& registry_hook() noexcept {
+        return hook;
+    }
+};
+
+// 改动之前的实现：全局 std::set + 单个互斥量，作为对照组
+class LegacyRegistry {
+    std::set<std::shared_ptr<FakeSession>> sessions_;
+    std::mutex mutex_;
+
+public:
+    std::size_t insert(std::shared_ptr<FakeSession> const& item) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        sessions_.insert(item);
+        return sessions_.size();
+    }
+
+    std::size_t erase(FakeSession& item) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        // 与旧代码一样按 shared_ptr 查找；这里借用一个不拥有对象的别名指针
+        sessions_.erase(std::shared_ptr<FakeSession>(std::shared_ptr<FakeSession>(), &item));
+        return sessions_.size();
+    }
+
+    template<class Function>
+    void for_each(Function&& fn) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for(auto const& item : sessions_) {
+            fn(item);
+        }
+    }
+};
+
+std::vector<std::shared_ptr<FakeSession>> make_sessions(std::size_t count, std::uint64_t first_id) {
+    std::vector<std::shared_ptr<FakeSession>> out;
+    out.reserve(count);
+    for(std::size_t i = 0; i < count; ++i) {
+        auto s = std::make_shared<FakeSession>();
+        s->id = first_id + i;
+        out.push_back(std::move(s));
+    }
+    return out;
+}
+
+// 在 threads 个线程上运行 body(thread_index, stop)，返回每个线程完成的操作数
+template<class Body>
+std::vector<std::uint64_t> run_threads(unsigned threads, double seconds, Body body) {
+    std::atomic<bool> stop{false};
+    std::vector<std::uint64_t> ops(threads, 0);
+    std::vector<std::thread> workers;
+    for(unsigned t = 0; t < threads; ++t) {
+        workers.emplace_back([&, t] { ops[t] = body(t, stop); });
+    }
+    std::this_thread::sleep_for(std::chrono::duration<double>(seconds));
+    stop = true;
+    for(auto& w : workers) {
+        w.join();
+    }
+    return ops;
+}
+
+template<class Registry>
+void run_scenarios(bench::Reporter& reporter, char const* impl,
+                   std::size_t population, double seconds, unsigned threads) {
+    auto const params = std::vector<std::pair<std::string, std::string>>{
+        {"impl", impl},
+        {"threads", std::to_string(threads)},
+        {"population", std::to_string(population)}};
+
+    // connect_disconnect：每个线程登记、注销自己的一批会话
+    {
+        Registry registry(std::thread::hardware_concurrency() * 4);
+        auto resident = make_sessions(population, 0);
+        for(auto const& s : resident) registry.insert(s);
+
+        auto ops = run_threads(threads, seconds, [&](unsigned t, std::atomic<bool>& stop) {
+            auto own = make_sessions(64, (t + 1) * 1000000ull);
+            std::uint64_t n = 0;
+            while(!stop.load(std::memory_order_relaxed)) {
+                for(auto const& s : own) registry.insert(s);
+                for(auto const& s : own) registry.erase(*s);
+                n += own.size();
+            }
+            return n;
+        });
+
+        std::uint64_t total = 0;
+        for(auto n : ops) total += n;
+        auto result = bench::Result{"connect_disconnect", params, {}};
+        result.metrics.emplace_back("pairs_per_sec", total / seconds);
+        result.metrics.emplace_back("ns_per_pair", seconds * 1e9 * threads / (total ? total : 1));
+        reporter.add(std::move(result));
+    }
+
+    // broadcast：每个线程遍历全部会话
+    {
+        Registry registry(std::thread::hardware_concurrency() * 4);
+        auto resident = make_sessions(population, 0);
+        for(auto const& s : resident) registry.insert(s);
+
+        auto ops = run_threads(threads, seconds, [&](unsigned, std::atomic<bool>& stop) {
+            std::uint64_t n = 0;
+            std::uint64_t sum = 0;
+            while(!stop.load(std::memory_order_relaxed)) {
+                registry.for_each([&](std::shared_ptr<FakeSession> const& s) { sum += s->id; });
+                ++n;
+            }
+            bench::do_not_optimize(sum);
+            return n;
+        });
+
+        std::uint64_t total = 0;
+        for(auto n : ops) total += n;
+        auto result = bench::Result{"broadcast", params, {}};
+        result.metrics.emplace_back("broadcasts_per_sec", total / seconds);
+        result.metrics.emplace_back("ns_per_recipient",
+            seconds * 1e9 * threads / (total ? total : 1) / population);
+        reporter.add(std::move(result));
+    }
+
+    // mixed：线程 0 做连接/断开，其余线程广播
+    if(threads > 1) {
+        Registry registry(std::thread::hardware_concurrency() * 4);
+        auto resident = make_sessions(population, 0);
+        for(auto const& s : resident) registry.insert(s);
+
+        auto ops = run_threads(threads, seconds, [&](unsigned t, std::atomic<bool>& stop) {
+            std::uint64_t n = 0;
+            if(t == 0) {
+                auto own = make_sessions(64, 1000000ull);
+                while(!stop.load(std::memory_order_relaxed)) {
+                    for(auto const& s : own) registry.insert(s);
+                    for(auto const& s : own) registry.erase(*s);
+                    n += own.size();
+                }
+                return n;
+            }
+            std::uint64_t sum = 0;
+            while(!stop.load(std::memory_order_relaxed)) {
+                registry.for_each([&](std::shared_ptr<FakeSession> const& s) { sum += s->id; });
+                ++n;
+            }
+            bench::do_not_optimize(sum);
+            return n;
+        });
+
+        std::uint64_t broadcasts = 0;
+        for(unsigned t = 1; t < threads; ++t) broadcasts += ops[t];
+        auto result = bench::Result{"mixed", params, {}};
+        result.metrics.emplace_back("churn_pairs_per_sec", ops[0] / seconds);
+        result.metrics.emplace_back("broadcasts_per_sec", broadcasts / seconds);
+        reporter.add(std::move(result));
+    }
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    std::size_t const population = argc > 1 ? std::atoi(argv[1]) : 10000;
+    double const seconds = argc > 2 ? std::atof(argv[2]) : 0.5;
+
+    // LegacyRegistry 不分片，忽略构造参数
+    struct Legacy : LegacyRegistry {
+        explicit Legacy(std::size_t) {}
+    };
+
+    bench::Reporter reporter("registry");
+    for(unsigned threads : {1u, 2u, 4u, 8u}) {
+        run_scenarios<Legacy>(reporter, "set_mutex", population, seconds, threads);
+        run_scenarios<SessionRegistry<FakeSession>>(reporter, "sharded", population, seconds, threads);
+    }
+    reporter.print();
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,287 @@
+// 服务器热路径微基准
+//
+// 单线程测量以下操作，每项反复运行直到达到指定时长：
+//   frame_encode       frame::encode 编码服务端帧（Session::publish 的做法）
+//   frame_decode       Beast 在服务端角色下读取并解掩码一条客户端帧（Session::on_read 的做法）
+//   payload_copy       beast::buffers_to_string 复制负载 与 直接取 string_view 的对比，各自再加上编码；
+//                      frame_buffer 为读入池化帧缓冲区后原地封装帧头（Session::on_read 的做法）
+//   registry           SessionRegistry 的登记、注销与遍历
+//   fanout             FanOut 向 1 / 100 / 10000 个进程内假会话广播，包括入队与模拟写完成
+//
+// 用法: server_bench [每项的秒数]
+// 结果以 JSON 输出到标准输出
+
+#define BOOST_BEAST_USE_STD_STRING_VIEW
+
+#include "bench.hpp"
+#include "fanout.hpp"
+#include "frame_buffer.hpp"
+#include "io_context_pool.hpp"
+#include "outbound_queue.hpp"
+#include "session_registry.hpp"
+#include "websocket_frame.hpp"
+
+#include <boost/beast/core.hpp>
+#include <boost/beast/websocket.hpp>
+#include <boost/beast/_experimental/test/stream.hpp>
+#include <cstdlib>                       // std::atof
+#include <memory>                        // 智能指针支持
+#include <random>                        // 掩码密钥
+#include <string>                        // std::string 支持
+#include <string_view>                   // std::string_view 支持
+#include <vector>                        // std::vector 容器
+
+namespace beast = boost::beast;
+namespace websocket = beast::websocket;
+namespace net = boost::asio;
+
+namespace {
+
+double min_seconds = 0.5;                    // 每项至少运行的秒数
+
+// 反复调用 fn（每次完成 ops 个操作），直到一轮耗时达到 min_seconds，返回每个操作的纳秒数
+// 每轮调用次数加倍，计时本身的开销被摊薄到可以忽略
+template<class Function>
+double measure(std::size_t ops, Function&& fn) {
+    // 预热一次，避免把首次分配与缓存未命中计入结果
+    fn();
+    for(std::size_t calls = 1;; calls *= 2) {
+        auto const start = bench::clock::now();
+        for(std::size_t i = 0; i < calls; ++i) {
+            fn();
+        }
+        auto const elapsed = bench::seconds_since(start);
+        if(elapsed >= min_seconds) {
+            return elapsed * 1e9 / static_cast<double>(calls * ops);
+        }
+    }
+}
+
+std::string make_payload(std::size_t size) {
+    return std::string(size, 'x');
+}
+
+// 编码一条带掩码的客户端文本帧（客户端 → 服务端的帧必须带掩码）
+std::string encode_masked(std::string const& payload, std::uint32_t key) {
+    unsigned char header[frame::max_header_size];
+    auto const header_size = frame::encode_header(frame::opcode::text, payload.size(), header);
+    header[1] |= 0x80;
+
+    std::string out(reinterpret_cast<char*>(header), header_size);
+    unsigned char mask[4];
+    for(int i = 0; i < 4; ++i) {
+        mask[i] = static_cast<unsigned char>(key >> (8 * i));
+        out.push_back(static_cast<char>(mask[i]));
+    }
+    for(std::size_t i = 0; i < payload.size(); ++i) {
+        out.push_back(static_cast<char>(payload[i] ^ mask[i % 4]));
+    }
+    return out;
+}
+
+void bench_frame_encode(bench::Reporter& reporter) {
+    for(std::size_t size : {16, 1024, 65536}) {
+        auto const payload = make_payload(size);
+        auto const ns = measure(1, [&] {
+            auto out = frame::encode(frame::opcode::text, payload);
+            bench::do_not_optimize(out.data());
+        });
+        reporter.add({"frame_encode", {{"size", std::to_string(size)}},
+            {{"ns_per_op", ns}, {"mb_per_sec", size / ns * 1e3}}});
+    }
+}
+
+void bench_frame_decode(bench::Reporter& reporter) {
+    constexpr std::size_t batch = 64;
+
+    for(std::size_t size : {16, 1024, 65536}) {
+        net::io_context ioc;
+        beast::test::stream server(ioc);
+        beast::test::stream client(ioc);
+        server.connect(client);
+
+        // 以原始 HTTP 升级请求完成握手，握手响应写到 client 一端
+        websocket::stream<beast::test::stream&> ws(server);
+        server.append(
+            "GET / HTTP/1.1\r\n"
+            "Host: localhost\r\n"
+            "Upgrade: websocket\r\n"
+            "Connection: Upgrade\r\n"
+            "Sec-WebSocket-Key: dGhlIHNhbXBsZSBub25jZQ==\r\n"
+            "Sec-WebSocket-Version: 13\r\n\r\n");
+        ws.accept();
+
+        std::string frames;
+        auto const one = encode_masked(make_payload(size), std::mt19937{42}());
+        for(std::size_t i = 0; i < batch; ++i) {
+            frames += one;
+        }
+
+        beast::flat_buffer buffer;
+        auto const ns = measure(batch, [&] {
+            server.append(frames);
+            for(std::size_t i = 0; i < batch; ++i) {
+                ws.read(buffer);
+                bench::do_not_optimize(buffer.data().data());
+                buffer.consume(buffer.size());
+            }
+        });
+        reporter.add({"frame_decode", {{"size", std::to_string(size)}},
+            {{"ns_per_op", ns}, {"mb_per_sec", size / ns * 1e3}}});
+    }
+}
+
+void bench_payload_copy(bench::Reporter& reporter) {
+    for(std::size_t size : {16, 1024, 65536}) {
+        beast::flat_buffer buffer;
+        auto const payload = make_payload(size);
+        net::buffer_copy(buffer.prepare(size), net::buffer(payload));
+        buffer.commit(size);
+
+        auto const copy_ns = measure(1, [&] {
+            auto s = beast::buffers_to_string(buffer.data());
+            bench::do_not_optimize(s.data());
+        });
+        auto const view_ns = measure(1, [&] {
+            std::string_view v(static_cast<char const*>(buffer.data().data()), buffer.size());
+            bench::do_not_optimize(v.data());
+        });
+        auto const copy_encode_ns = measure(1, [&] {
+            auto out = frame::encode(frame::opcode::text, beast::buffers_to_string(buffer.data()));
+            bench::do_not_optimize(out.data());
+        });
+        auto const view_encode_ns = measure(1, [&] {
+            std::string_view v(static_cast<char const*>(buffer.data().data()), buffer.size());
+            auto out = frame::encode(frame::opcode::text, v);
+            bench::do_not_optimize(out.data());
+        });
+
+        // 模拟 Beast 把负载写入缓冲区，然后原地写帧头；缓冲区释放后回到线程的空闲链表
+        auto const frame_buffer_ns = measure(1, [&] {
+            auto in = FrameBuffer::create();
+            if(in->capacity() < size) {
+                in = FrameBuffer::create(size);
+            }
+            in->commit(net::buffer_copy(in->prepare(), net::buffer(payload)));
+            in->seal(frame::opcode::text);
+            FrameRef const out = std::move(in);
+            bench::do_not_optimize(out->data());
+        });
+
+        reporter.add({"payload_copy", {{"size", std::to_string(size)}, {"impl", "buffers_to_string"}},
+            {{"ns_per_op", copy_ns}, {"encode_ns_per_op", copy_encode_ns}}});
+        reporter.add({"payload_copy", {{"size", std::to_string(size)}, {"impl", "string_view"}},
+            {{"ns_per_op", view_ns}, {"encode_ns_per_op", view_encode_ns}}});
+        reporter.add({"payload_copy", {{"size", std::to_string(size)}, {"impl", "frame_buffer"}},
+            {{"encode_ns_per_op", frame_buffer_ns}}});
+    }
+}
+
+// 基准用的假会话：登记挂钩和一个发送队列，send 与真实会话一样入队
+struct FakeSession {
+    RegistryHook hook;
+    OutboundQueue queue;
+    QueueLimits const* limits = nullptr;
+
+    RegistryHook& registry_hook() noexcept {
+        return hook;
+    }
+
+    void send(FrameRef const& frame,
+              std::shared_ptr<tracing::MessageTrace> const& trace) {
+        queue.push(frame, *limits, trace);
+    }
+
+    // 模拟一次写操作完成：取出全部待发送帧再移出队列
+    void flush() {
+        if(queue.has_pending()) {
+            auto const buffers = queue.begin_write(256 * 1024);
+            bench::do_not_optimize(buffers.begin());
+            queue.complete_write();
+        }
+    }
+};
+
+std::vector<std::shared_ptr<FakeSession>> make_sessions(std::size_t count, QueueLimits const& limits) {
+    std::vector<std::shared_ptr<FakeSession>> out;
+    out.reserve(count);
+    for(std::size_t i = 0; i < count; ++i) {
+        auto s = std::make_shared<FakeSession>();
+        s->limits = &limits;
+        out.push_back(std::move(s));
+    }
+    return out;
+}
+
+void bench_registry(bench::Reporter& reporter) {
+    QueueLimits const limits;
+    for(std::size_t count : {100, 10000}) {
+        auto sessions = make_sessions(count, limits);
+        SessionRegistry<FakeSession> registry(1, 4);
+
+        auto const insert_erase_ns = measure(count, [&] {
+            for(auto const& s : sessions) {
+                registry.insert(s, 0);
+            }
+            for(auto const& s : sessions) {
+                registry.erase(*s);
+            }
+        });
+
+        for(auto const& s : sessions) {
+            registry.insert(s, 0);
+        }
+        auto const iterate_ns = measure(count, [&] {
+            registry.for_each([](std::shared_ptr<FakeSession> const& s) {
+                bench::do_not_optimize(s.get());
+            });
+        });
+
+        reporter.add({"registry", {{"sessions", std::to_string(count)}},
+            {{"insert_erase_ns_per_op", insert_erase_ns}, {"iterate_ns_per_session", iterate_ns}}});
+    }
+}
+
+void bench_fanout(bench::Reporter& reporter) {
+    QueueLimits const limits;
+    IoContextPool pool(1);                       // 单个事件循环：接收者全部在发送者所在的循环上直接投递
+    FanOut<FakeSession> fanout(pool);
+    auto const payload = make_payload(64);
+
+    for(std::size_t count : {1, 100, 10000}) {
+        auto members = std::make_shared<SessionRegistry<FakeSession>>(1, 4);
+        auto sessions = make_sessions(count, limits);
+        for(auto const& s : sessions) {
+            members->insert(s, 0);
+        }
+        std::shared_ptr<FakeSession const> const sender = std::make_shared<FakeSession>();
+
+        auto const ns = measure(1, [&] {
+            auto const out = FrameBuffer::make(frame::opcode::text, payload);
+            fanout.publish(members, 0, out, sender);
+            for(auto const& s : sessions) {
+                s->flush();
+            }
+        });
+
+        reporter.add({"fanout", {{"recipients", std::to_string(count)}},
+            {{"ns_per_publish", ns}, {"ns_per_recipient", ns / static_cast<double>(count)}}});
+    }
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    if(argc > 1) {
+        min_seconds = std::atof(argv[1]);
+    }
+
+    bench::Reporter reporter("server_bench");
+    bench_frame_encode(reporter);
+    bench_frame_decode(reporter);
+    bench_payload_copy(reporter);
+    bench_registry(reporter);
+    bench_fanout(reporter);
+    reporter.print();
+    return 0;
+}
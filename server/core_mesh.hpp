@@ -0,0 +1,257 @@
+#pragma once
+
+#include "frame_buffer.hpp"              // 共享帧
+#include "io_context_pool.hpp"           // 事件循环池
+#include "metrics.hpp"                   // 通道溢出计数
+#include "session_registry.hpp"          // RegistryHook
+#include "spsc_ring.hpp"                 // 核心之间的单生产者 / 单消费者通道
+#include "trace.hpp"                     // 消息延迟追踪
+
+#include <boost/asio/post.hpp>           // 唤醒目标核心
+#include <atomic>                        // 通道的唤醒标志
+#include <cstddef>                       // std::size_t
+#include <cstdint>                       // std::uint64_t
+#include <memory>                        // 智能指针支持
+#include <mutex>                         // 互斥量支持
+#include <string>                        // std::string 支持
+#include <unordered_map>                 // 房间编号 → 成员
+#include <vector>                        // std::vector 容器
+
+// 房间名 → 房间编号
+//
+// 核心之间只传递编号，不传递房间名或共享的房间对象。编号只增不复用：房间在全部核心上都变空后
+// 名字被移除，之后再创建的同名房间得到新编号，通道中残留的旧编号消息在任何核心上都找不到成员。
+// 只在加入、离开房间时加锁访问，不在消息路径上。
+class RoomIds {
+public:
+    // 房间在每个核心上的成员数：由成员所在核心在加入、离开时更新，发布时任意核心不加锁读取，
+    // 只向有成员的核心推入投递
+    struct Interest {
+        std::unique_ptr<std::atomic<std::size_t>[]> members;
+
+        explicit Interest(std::size_t cores)
+            : members(new std::atomic<std::size_t>[cores]()) {}
+    };
+
+    // acquire 的结果
+    struct Room {
+        std::uint64_t id;                             // 房间编号
+        std::shared_ptr<Interest> interest;           // 各核心的成员数
+    };
+
+private:
+    struct Entry {
+        Room room;
+        std::size_t refs;                             // 全部核心上的成员总数
+    };
+
+    std::size_t const cores_;                         // 核心数
+    mutable std::mutex mutex_;                        // 保护以下成员
+    std::unordered_map<std::string, Entry> ids_;      // 非空房间
+    std::uint64_t next_ = 1;                          // 下一个新编号
+
+public:
+    explicit RoomIds(std::size_t cores)
+        : cores_(cores) {}
+
+    // 增加一个成员，返回房间编号与各核心的成员数（房间不存在时分配新编号）
+    Room acquire(std::string const& name) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = ids_.find(name);
+        if(it == ids_.end()) {
+            it = ids_.emplace(name, Entry{Room{next_++, std::make_shared<Interest>(cores_)}, 0}).first;
+        }
+        ++it->second.refs;
+        return it->second.room;
+    }
+
+    // 减少一个成员，房间变空时移除
+    void release(std::string const& name) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = ids_.find(name);
+        if(it != ids_.end() && --it->second.refs == 0) {
+            ids_.erase(it);
+        }
+    }
+
+    // 当前非空房间数
+    std::size_t size() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return ids_.size();
+    }
+};
+
+// 无共享（thread-per-core）模式下核心之间的消息网格
+//
+// 每个核心（事件循环）有自己的接受器、会话与房间成员表，成员表只由本核心的线程访问，不加锁。
+// 任意两个核心之间各有一条有界的单生产者 / 单消费者通道：发布时本核心的成员直接发送，
+// 其余有该房间成员的核心各推入一条 {房间编号, 帧}，由目标核心从通道中取出后发送给本核心的成员。
+// 消息路径上不读写任何全局结构，各核心只共享帧本身与通道两端的下标。
+//
+// 通道带一个唤醒标志：生产者只在消费者没有待执行的取出任务时向目标核心投递一次，
+// 一批消息只唤醒一次。通道已满时丢弃这条投递并计入 core_ring_overflows。
+template<class T>
+class CoreMesh {
+public:
+    using Trace = std::shared_ptr<tracing::MessageTrace>;
+
+private:
+    // 通道中的一条投递
+    struct Delivery {
+        std::uint64_t room = 0;                       // 房间编号
+        FrameRef frame;                               // 共享帧
+        Trace trace;                                  // 消息的追踪，未启用追踪时为空
+    };
+
+    // 房间成员：挂钩的 slot 记录成员在数组中的下标，离开时 O(1) 删除
+    struct Member {
+        T* item;
+        RegistryHook* hook;
+    };
+
+    // 一个房间在本核心上的部分
+    struct Room {
+        std::vector<Member> members;                  // 本核心的成员
+        std::shared_ptr<RoomIds::Interest> interest;  // 各核心的成员数，与其他核心共享
+    };
+
+    // 一个核心独占的状态，只在该核心的线程上访问
+    struct alignas(64) Core {
+        std::unordered_map<std::uint64_t, Room> rooms;  // 房间编号 → 本核心的部分
+    };
+
+    // 从 src 到 dst 的通道
+    struct Link {
+        SpscRing<Delivery> ring;                      // 待投递的消息
+        alignas(64) std::atomic<bool> scheduled{false};  // 已向 dst 投递取出任务且尚未取空
+
+        explicit Link(std::size_t capacity)
+            : ring(capacity) {}
+    };
+
+    IoContextPool& pool_;                             // 全部核心的事件循环
+    std::size_t const cores_;                         // 核心数
+    RoomIds ids_;                                     // 房间名 → 编号
+    std::unique_ptr<Core[]> local_;                   // 每个核心的成员表
+    std::vector<std::unique_ptr<Link>> links_;        // links_[src * cores_ + dst]
+
+public:
+    // ring_size 为每条通道的容量
+    CoreMesh(IoContextPool& pool, std::size_t ring_size)
+        : pool_(pool),
+          cores_(pool.size()),
+          ids_(cores_),
+          local_(new Core[cores_]) {
+        links_.reserve(cores_ * cores_);
+        for(std::size_t i = 0; i < cores_ * cores_; ++i) {
+            links_.push_back(std::make_unique<Link>(ring_size));
+        }
+    }
+
+    CoreMesh(CoreMesh const&) = delete;
+    CoreMesh& operator=(CoreMesh const&) = delete;
+
+    // 在 core 的线程上调用：把 member 加入名为 name 的房间，使用调用方持有的 hook；返回房间编号
+    std::uint64_t join(std::size_t core, std::string const& name, T* member, RegistryHook& hook) {
+        auto const room = ids_.acquire(name);
+        auto& local = local_[core].rooms[room.id];
+        if(!local.interest) {
+            local.interest = room.interest;
+        }
+        hook.shard = 0;
+        hook.slot = local.members.size();
+        local.members.push_back(Member{member, &hook});
+        local.interest->members[core].fetch_add(1, std::memory_order_relaxed);
+        return room.id;
+    }
+
+    // 在 core 的线程上调用：注销 hook 对应的成员
+    void leave(std::size_t core, std::string const& name, std::uint64_t id, RegistryHook& hook) {
+        auto& rooms = local_[core].rooms;
+        auto it = rooms.find(id);
+        if(it == rooms.end() || hook.shard == RegistryHook::npos) {
+            return;
+        }
+        auto& members = it->second.members;
+        auto const slot = hook.slot;
+        members[slot] = members.back();
+        members[slot].hook->slot = slot;
+        members.pop_back();
+        hook.shard = RegistryHook::npos;
+        it->second.interest->members[core].fetch_sub(1, std::memory_order_relaxed);
+        if(members.empty()) {
+            rooms.erase(it);
+        }
+        ids_.release(name);
+    }
+
+    // 当前非空房间数
+    std::size_t room_count() const {
+        return ids_.size();
+    }
+
+    // 在 origin 核心上调用：把 frame 发送给 room 的全部成员（sender 除外）
+    void publish(std::size_t origin, std::uint64_t room, FrameRef const& frame,
+                 T const* sender, Trace const& trace = nullptr) {
+        // 发送者是本核心上的成员，成员数经由本核心的房间取得；找不到时退回投递给全部核心
+        auto const& rooms = local_[origin].rooms;
+        auto const local = rooms.find(room);
+        auto const* interest = local != rooms.end() ? local->second.interest.get() : nullptr;
+        for(std::size_t core = 0; core < cores_; ++core) {
+            // 没有该房间成员的核心不投递，不占用通道容量
+            if(core == origin ||
+               (interest && interest->members[core].load(std::memory_order_relaxed) == 0)) {
+                continue;
+            }
+            auto& link = *links_[origin * cores_ + core];
+            if(!link.ring.push(Delivery{room, frame, trace})) {
+                metrics::add(metrics::Counter::core_ring_overflows);
+                continue;
+            }
+            // 与 drain 中清除标志之后的检查配对：两边都先写后读，至少一方能看到对方的写入
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if(!link.scheduled.load(std::memory_order_relaxed) &&
+               !link.scheduled.exchange(true, std::memory_order_acq_rel)) {
+                boost::asio::post(pool_.get(core), [this, origin, core] {
+                    drain(origin, core);
+                });
+            }
+        }
+
+        // 本核心的成员最后处理，让其他核心尽早开始工作
+        deliver(origin, room, frame, sender, trace);
+    }
+
+private:
+    // 在 dst 的线程上调用：取空 src → dst 通道并投递给本核心的成员
+    void drain(std::size_t src, std::size_t dst) {
+        auto& link = *links_[src * cores_ + dst];
+        Delivery d;
+        for(;;) {
+            while(link.ring.pop(d)) {
+                deliver(dst, d.room, d.frame, nullptr, d.trace);
+            }
+            link.scheduled.store(false, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            // 清除标志之前推入的消息由本次继续取出；之后推入的由生产者重新投递的任务取出
+            if(link.ring.empty() || link.scheduled.exchange(true, std::memory_order_acq_rel)) {
+                return;
+            }
+        }
+    }
+
+    // 在 core 的线程上调用：发送给本核心中 room 的全部成员
+    void deliver(std::size_t core, std::uint64_t room, FrameRef const& frame,
+                 T const* sender, Trace const& trace) {
+        auto& rooms = local_[core].rooms;
+        auto it = rooms.find(room);
+        if(it == rooms.end()) {
+            return;
+        }
+        for(auto const& member : it->second.members) {
+            if(member.item != sender) {
+                member.item->send(frame, trace);
+            }
+        }
+    }
+};
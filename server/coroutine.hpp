@@ -0,0 +1,46 @@
+#pragma once
+
+#include "handler_allocator.hpp"         // 会话的处理器内存
+
+#include <boost/asio/awaitable.hpp>      // net::awaitable
+#include <boost/asio/co_spawn.hpp>       // net::co_spawn
+#include <boost/asio/detached.hpp>       // net::detached
+#include <boost/asio/io_context.hpp>     // io_context 的具体执行器类型
+#include <boost/asio/redirect_error.hpp> // 把错误码写入变量而不是抛出异常
+#include <boost/asio/use_awaitable.hpp>  // net::use_awaitable_t
+
+// 协程会话路径（WEBSOCKET_COROUTINES，需要 C++20）的公共定义
+//
+// 协程与会话的流一样使用 io_context 的具体执行器，不经过多态的 any_io_executor；
+// 每个 co_await 的操作状态从会话的 HandlerMemory 分配，错误以错误码返回，
+// 连接结束这样的常见情况不需要抛出异常。协程帧本身由 Asio 的线程局部缓存回收。
+#if WEBSOCKET_COROUTINES && !defined(BOOST_ASIO_HAS_CO_AWAIT)
+#error "WEBSOCKET_COROUTINES 需要 Asio 的协程支持：请使用 C++20 编译，GCC 10 还需加上 -fcoroutines"
+#endif
+
+#if defined(BOOST_ASIO_HAS_CO_AWAIT)
+
+namespace coro {
+
+using executor_type = boost::asio::io_context::executor_type;
+
+// 在事件循环上运行、结果为 T 的协程
+template<class T = void>
+using Awaitable = boost::asio::awaitable<T, executor_type>;
+
+// co_await 的完成令牌：操作状态从 memory 分配，错误写入 ec
+inline auto use_memory(HandlerMemory& memory, boost::system::error_code& ec) {
+    return boost::asio::redirect_error(
+        AllocatorToken<HandlerAllocator<void>, boost::asio::use_awaitable_t<executor_type>>{
+            HandlerAllocator<void>(memory), {}},
+        ec);
+}
+
+// 只把错误写入 ec、操作状态按 Asio 默认方式分配的完成令牌，供基准对比
+inline auto use_default(boost::system::error_code& ec) {
+    return boost::asio::redirect_error(boost::asio::use_awaitable_t<executor_type>(), ec);
+}
+
+} // namespace coro
+
+#endif
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <string>                        // sysfs 路径
+
+#ifdef __linux__
+#include <dirent.h>                      // 读取 sysfs 目录
+#include <pthread.h>                     // pthread_setaffinity_np
+#include <sched.h>                       // cpu_set_t
+#include <sys/socket.h>                  // SO_INCOMING_CPU
+#endif
+
+// 线程的 CPU 绑定、NUMA 节点查询与按接收 CPU 引导连接
+//
+// 只依赖 Linux 系统调用与 sysfs，不需要 libnuma；其他平台上各函数什么也不做并返回失败。
+// 内存按首次访问分配在访问线程所在的节点上，因此线程绑定之后由它自己申请并写入的内存即为本地内存。
+namespace affinity {
+
+// 把调用线程绑定到 cpu，成功返回 true
+inline bool pin_current_thread(int cpu) {
+#ifdef __linux__
+    if(cpu < 0 || cpu >= CPU_SETSIZE) {
+        return false;
+    }
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+#else
+    (void)cpu;
+    return false;
+#endif
+}
+
+// cpu 所在的 NUMA 节点，未知时返回 -1
+inline int numa_node(int cpu) {
+#ifdef __linux__
+    auto const path = "/sys/devices/system/cpu/cpu" + std::to_string(cpu);
+    DIR* dir = ::opendir(path.c_str());
+    if(!dir) {
+        return -1;
+    }
+    int node = -1;
+    while(auto* entry = ::readdir(dir)) {
+        std::string const name = entry->d_name;
+        if(name.size() > 4 && name.compare(0, 4, "node") == 0 &&
+           name.find_first_not_of("0123456789", 4) == std::string::npos) {
+            node = std::stoi(name.substr(4));
+            break;
+        }
+    }
+    ::closedir(dir);
+    return node;
+#else
+    (void)cpu;
+    return -1;
+#endif
+}
+
+// 已连接 socket 的数据包由哪个 CPU 接收（网卡接收队列中断所在的核心），未知时返回 -1
+inline int incoming_cpu(int fd) {
+#if defined(__linux__) && defined(SO_INCOMING_CPU)
+    int cpu = -1;
+    socklen_t len = sizeof(cpu);
+    if(::getsockopt(fd, SOL_SOCKET, SO_INCOMING_CPU, &cpu, &len) != 0) {
+        return -1;
+    }
+    return cpu;
+#else
+    (void)fd;
+    return -1;
+#endif
+}
+
+// 在监听 socket 上声明它服务于 cpu：SO_REUSEPORT 组中内核优先把在该 CPU 上收到的连接交给它
+inline bool set_incoming_cpu(int fd, int cpu) {
+#if defined(__linux__) && defined(SO_INCOMING_CPU)
+    return ::setsockopt(fd, SOL_SOCKET, SO_INCOMING_CPU, &cpu, sizeof(cpu)) == 0;
+#else
+    (void)fd;
+    (void)cpu;
+    return false;
+#endif
+}
+
+} // namespace affinity
@@ -0,0 +1,97 @@
+#pragma once
+
+#include "frame_buffer.hpp"              // 共享帧
+#include "io_context_pool.hpp"           // 事件循环池
+#include "metrics.hpp"                   // 每批投递数
+#include "mpsc_inbox.hpp"                // 每个事件循环的收件箱
+#include "session_registry.hpp"          // 分片会话注册表
+#include "trace.hpp"                     // 消息延迟追踪
+
+#include <boost/asio/post.hpp>           // 唤醒其他事件循环
+#include <cstddef>                       // std::size_t
+#include <memory>                        // 智能指针支持
+#include <vector>                        // std::vector 容器
+
+// 跨事件循环的广播
+//
+// 接收者注册表（全部会话或某个房间的成员）按事件循环分组，每个会话只登记在自己所属循环的分组里。
+// 广播时本循环的接收者直接投递，其余有接收者的循环各收到一条放入其收件箱的投递，
+// 由目标循环自己的线程取出、遍历本组会话并调用 T::send，
+// 因此 send 永远在接收者所属的线程上执行，会话的写队列无需加锁。
+//
+// 收件箱是无锁的多生产者 / 单消费者链表：只有把投递放入空收件箱的那个生产者向目标循环 post 一次，
+// 目标循环一次取走这段时间内全部线程放入的投递，高并发广播时不再为每条消息各唤醒一次。
+template<class T>
+class FanOut {
+    using Members = std::shared_ptr<SessionRegistry<T> const>;
+    using Trace = std::shared_ptr<tracing::MessageTrace>;
+
+    // 收件箱中的一条投递
+    struct Delivery {
+        Members members;                              // 接收者注册表
+        FrameRef frame;                               // 共享帧
+        std::shared_ptr<T const> sender;              // 发送者，不发送给它
+        Trace trace;                                  // 消息的追踪，未启用追踪时为空
+    };
+
+    IoContextPool& pool_;                             // 全部事件循环
+    std::vector<std::unique_ptr<MpscInbox<Delivery>>> inboxes_;  // 每个事件循环一个收件箱
+
+public:
+    explicit FanOut(IoContextPool& pool)
+        : pool_(pool) {
+        inboxes_.reserve(pool_.size());
+        for(std::size_t loop = 0; loop < pool_.size(); ++loop) {
+            inboxes_.push_back(std::make_unique<MpscInbox<Delivery>>());
+        }
+    }
+
+    // 在 origin 循环上调用：把 frame 发送给 members 中除 sender 以外的所有会话
+    // members 以 shared_ptr 传入，保证其他循环取出投递时注册表仍然有效
+    // trace 非空时随帧交给每个接收者的 send
+    void publish(Members const& members,
+                 std::size_t origin,
+                 FrameRef const& frame,
+                 std::shared_ptr<T const> const& sender,
+                 Trace const& trace = nullptr) {
+        for(std::size_t loop = 0; loop < pool_.size(); ++loop) {
+            // 没有接收者的循环不投递：成员集中在少数循环上的小房间不必唤醒其余循环
+            if(loop == origin || members->empty(loop)) {
+                continue;
+            }
+            // 持有 sender 的引用，防止它被释放后地址被新会话复用而误排除
+            if(inboxes_[loop]->push(Delivery{members, frame, sender, trace})) {
+                boost::asio::post(pool_.get(loop), [this, loop] {
+                    drain(loop);
+                });
+            }
+        }
+
+        // 本循环的接收者最后处理，让其他循环尽早开始工作
+        if(!members->empty(origin)) {
+            deliver(*members, origin, frame, sender.get(), trace);
+        }
+    }
+
+private:
+    // 在 loop 循环的线程上调用：取出收件箱中的全部投递
+    void drain(std::size_t loop) {
+        auto const count = inboxes_[loop]->drain([loop](Delivery const& d) {
+            deliver(*d.members, loop, d.frame, d.sender.get(), d.trace);
+        });
+        metrics::observe(metrics::Hist::inbox_batch, count);
+    }
+
+    // 在 loop 循环的线程上调用：发送给本组的全部会话
+    static void deliver(SessionRegistry<T> const& members,
+                        std::size_t loop,
+                        FrameRef const& frame,
+                        T const* sender,
+                        Trace const& trace) {
+        members.for_each(loop, [&](std::shared_ptr<T> const& session) {
+            if(session.get() != sender) {
+                session->send(frame, trace);
+            }
+        });
+    }
+};
@@ -0,0 +1,247 @@
+#pragma once
+
+#include "metrics.hpp"                   // 缓冲池空闲字节数
+#include "websocket_frame.hpp"           // 帧头编码
+
+#include <boost/asio/buffer.hpp>         // net::mutable_buffer
+#include <boost/smart_ptr/intrusive_ptr.hpp>  // 侵入式引用计数指针
+#include <array>                         // 各尺寸级别的空闲链表
+#include <atomic>                        // 原子引用计数
+#include <cstddef>                       // std::size_t
+#include <cstdint>                       // 定长整数类型
+#include <cstring>                       // std::memcpy
+#include <new>                           // operator new / delete
+#include <string_view>                   // std::string_view 支持
+#include <utility>                       // std::move
+#include <vector>                        // std::vector 容器
+
+class FrameBuffer;
+
+// 已封装好的共享帧：所有接收者的发送队列引用同一块内存，最后一个引用释放时归还内存池
+using FrameRef = boost::intrusive_ptr<FrameBuffer const>;
+
+// 接收与广播共用的帧缓冲区
+//
+// 内存布局：[FrameBuffer][帧头预留 max_header_size 字节][负载]
+// 读取时 Beast 把解掩码后的负载直接写入负载区；seal 把帧头写在负载之前的预留区中，
+// 得到连续的“帧头 + 负载”，不需要再复制负载就能交给所有接收者的发送队列。
+//
+// 内存块按 4KB、16KB、64KB、256KB 四个尺寸级别池化：每个事件循环（线程）各有一组空闲链表，
+// 释放时归还到释放者所在线程的链表，每个线程保留的空闲块总字节数不超过 retained_limit()；
+// 超过最大级别的缓冲区直接向堆申请、释放时归还堆。
+// 事件循环线程绑定 CPU 后以 set_thread_node 登记所在的 NUMA 节点：每块内存记录申请它的线程所在的节点，
+// 释放到另一个节点的线程时直接归还堆，不进入该线程的链表，各线程复用的内存始终是本地内存。
+// 引用计数是侵入式的，只有一次原子加减，不需要额外的控制块。
+class FrameBuffer {
+public:
+    static constexpr std::size_t class_count = 4;     // 尺寸级别数
+    static constexpr std::uint8_t unpooled = 0xff;    // 不属于任何级别（直接向堆申请）
+
+    // 各级别内存块的大小（含本结构与帧头预留）
+    static constexpr std::size_t block_size(std::size_t size_class) noexcept {
+        return std::size_t(4096) << (2 * size_class);
+    }
+
+private:
+    mutable std::atomic<std::uint32_t> refs_{0};      // 引用计数
+    std::uint8_t size_class_;                         // 所属尺寸级别，unpooled 表示不池化
+    std::int8_t node_;                                // 申请时所在线程的 NUMA 节点，-1 表示未知
+    std::size_t capacity_;                            // 负载区容量
+    std::size_t size_ = 0;                            // 已写入的负载字节数
+    std::size_t header_size_ = 0;                     // 帧头长度，seal 之后有效
+    boost::intrusive_ptr<FrameBuffer const> deflated_;  // 同一条消息压缩后的帧，发布前设置，之后只读
+
+    static inline std::atomic<std::size_t> retained_limit_{4 * 1024 * 1024};
+
+    // 线程局部的空闲块链表，每个尺寸级别一个
+    struct Pool {
+        std::array<std::vector<void*>, class_count> free;
+        std::size_t retained = 0;                     // 各链表中空闲块的总字节数
+        std::int8_t node = -1;                        // 本线程所在的 NUMA 节点，-1 表示未知
+        bool alive = true;                            // 线程退出析构后不再缓存
+
+        ~Pool() {
+            alive = false;
+            for(auto& list : free) {
+                for(void* p : list) {
+                    ::operator delete(p);
+                }
+            }
+        }
+    };
+
+    static Pool& pool() {
+        thread_local Pool p;
+        return p;
+    }
+
+    FrameBuffer(std::uint8_t size_class, std::int8_t node, std::size_t capacity) noexcept
+        : size_class_(size_class), node_(node), capacity_(capacity) {}
+
+    unsigned char* payload_begin() noexcept {
+        return reinterpret_cast<unsigned char*>(this + 1) + frame::max_header_size;
+    }
+
+    unsigned char const* payload_begin() const noexcept {
+        return reinterpret_cast<unsigned char const*>(this + 1) + frame::max_header_size;
+    }
+
+    // 每块内存中负载之前的字节数
+    static constexpr std::size_t overhead() noexcept {
+        return sizeof(FrameBuffer) + frame::max_header_size;
+    }
+
+public:
+    // 各级别内存块能容纳的最大负载
+    static constexpr std::size_t pooled_capacity(std::size_t size_class = 0) noexcept {
+        return block_size(size_class) - overhead();
+    }
+
+    // 每个线程最多保留的空闲块总字节数，应在事件循环启动前设置
+    static void set_retained_limit(std::size_t bytes) noexcept {
+        retained_limit_.store(bytes, std::memory_order_relaxed);
+    }
+
+    static std::size_t retained_limit() noexcept {
+        return retained_limit_.load(std::memory_order_relaxed);
+    }
+
+    // 登记调用线程所在的 NUMA 节点，应在线程绑定 CPU 之后、申请任何缓冲区之前调用
+    static void set_thread_node(int node) noexcept {
+        pool().node = static_cast<std::int8_t>(node >= 0 && node < 128 ? node : -1);
+    }
+
+    FrameBuffer(FrameBuffer const&) = delete;
+    FrameBuffer& operator=(FrameBuffer const&) = delete;
+
+    // 创建一个负载区至少为 capacity 字节的空缓冲区，优先取本线程对应级别的空闲块
+    static boost::intrusive_ptr<FrameBuffer> create(std::size_t capacity = pooled_capacity()) {
+        std::uint8_t size_class = 0;
+        while(size_class < class_count && capacity > pooled_capacity(size_class)) {
+            ++size_class;
+        }
+
+        auto& p = pool();
+        void* memory = nullptr;
+        if(size_class < class_count) {
+            capacity = pooled_capacity(size_class);
+            auto& list = p.free[size_class];
+            if(!list.empty()) {
+                memory = list.back();
+                list.pop_back();
+                p.retained -= block_size(size_class);
+                metrics::adjust(metrics::Gauge::pooled_bytes,
+                    -static_cast<std::int64_t>(block_size(size_class)));
+            }
+        } else {
+            size_class = unpooled;
+        }
+        if(!memory) {
+            memory = ::operator new(overhead() + capacity);
+        }
+        return boost::intrusive_ptr<FrameBuffer>(new(memory) FrameBuffer(size_class, p.node, capacity));
+    }
+
+    // 创建一条已封装的帧（系统回复等不经过读取路径的消息）
+    static FrameRef make(frame::opcode op, std::string_view payload) {
+        auto buffer = create(payload.size());
+        if(!payload.empty()) {
+            std::memcpy(buffer->payload_begin(), payload.data(), payload.size());
+        }
+        buffer->commit(payload.size());
+        buffer->seal(op);
+        return buffer;
+    }
+
+    // 负载区中尚未写入的部分，供读取直接写入
+    boost::asio::mutable_buffer prepare() noexcept {
+        return {payload_begin() + size_, capacity_ - size_};
+    }
+
+    // 确认读入了 n 字节负载
+    void commit(std::size_t n) noexcept {
+        size_ += n;
+    }
+
+    // 负载区是否已满
+    bool full() const noexcept {
+        return size_ == capacity_;
+    }
+
+    std::size_t capacity() const noexcept {
+        return capacity_;
+    }
+
+    // 扩容：返回负载区至少为 capacity 字节、已复制当前负载的新缓冲区
+    boost::intrusive_ptr<FrameBuffer> grow(std::size_t capacity) const {
+        auto bigger = create(capacity);
+        std::memcpy(bigger->payload_begin(), payload_begin(), size_);
+        bigger->size_ = size_;
+        return bigger;
+    }
+
+    // 已读入的负载
+    std::string_view payload() const noexcept {
+        return {reinterpret_cast<char const*>(payload_begin()), size_};
+    }
+
+    // 把 FIN=1 的无掩码帧头写在负载之前，之后 data()/size() 即为完整的服务端帧
+    // compressed 为 true 时置 RSV1，表示负载经过 permessage-deflate 压缩
+    void seal(frame::opcode op, bool compressed = false) noexcept {
+        unsigned char header[frame::max_header_size];
+        header_size_ = frame::encode_header(op, size_, header);
+        if(compressed) {
+            header[0] |= frame::rsv1;
+        }
+        std::memcpy(payload_begin() - header_size_, header, header_size_);
+    }
+
+    // 附上同一条消息压缩后的帧，由协商了压缩的接收者使用
+    void set_deflated(boost::intrusive_ptr<FrameBuffer const> deflated) noexcept {
+        deflated_ = std::move(deflated);
+    }
+
+    // 压缩后的帧，没有时为空
+    boost::intrusive_ptr<FrameBuffer const> const& deflated() const noexcept {
+        return deflated_;
+    }
+
+    // 完整的帧（帧头 + 负载），seal 之后有效
+    char const* data() const noexcept {
+        return reinterpret_cast<char const*>(payload_begin() - header_size_);
+    }
+
+    std::size_t size() const noexcept {
+        return header_size_ + size_;
+    }
+
+    friend void intrusive_ptr_add_ref(FrameBuffer const* p) noexcept {
+        p->refs_.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    friend void intrusive_ptr_release(FrameBuffer const* p) noexcept {
+        if(p->refs_.fetch_sub(1, std::memory_order_acq_rel) != 1) {
+            return;
+        }
+        auto const size_class = p->size_class_;
+        auto const node = p->node_;
+        void* memory = const_cast<FrameBuffer*>(p);
+        p->~FrameBuffer();
+
+        if(size_class != unpooled) {
+            auto& pl = pool();
+            auto const bytes = block_size(size_class);
+            if(pl.alive && pl.node == node && pl.retained + bytes <= retained_limit()) {
+                try {
+                    pl.free[size_class].push_back(memory);
+                    pl.retained += bytes;
+                    metrics::adjust(metrics::Gauge::pooled_bytes, static_cast<std::int64_t>(bytes));
+                    return;
+                } catch(std::bad_alloc const&) {
+                    // 链表扩容失败时直接归还堆
+                }
+            }
+        }
+        ::operator delete(memory);
+    }
+};
@@ -0,0 +1,324 @@
+#pragma once
+
+#include "handler_allocator.hpp"         // 把调用方处理器的分配器转交给内部操作
+#include "uring.hpp"                     // 可选的 io_uring 后端
+
+#include <boost/beast/core.hpp>          // 引入 Boost.Beast 核心功能
+#include <boost/beast/websocket/teardown.hpp>  // WebSocket 关闭时的 teardown 定制点
+#include <boost/asio/async_result.hpp>   // net::async_initiate
+#include <boost/asio/dispatch.hpp>       // io_uring 完成后调用处理器
+#include <boost/asio/io_context.hpp>     // io_context 的具体执行器类型
+#include <boost/asio/ip/tcp.hpp>         // 引入 Boost.Asio TCP 支持
+#include <boost/asio/write.hpp>          // net::async_write
+#include <type_traits>                   // std::decay_t
+#include <cerrno>                        // ECANCELED
+#include <functional>                    // std::function
+#include <memory>                        // 智能指针支持
+#include <utility>                       // std::move
+
+namespace beast = boost::beast;
+
+// 包装 TCP 流（beast::basic_stream）的 WebSocket 下层流
+//
+// 广播消息以预先编码好的原始帧直接写入 tcp_stream，绕过 websocket::stream 的写路径；
+// 而 Beast 在读取过程中仍会自行写出 pong、close 等控制帧以及握手响应。
+// 这个类保证两路写入互不交错：原始帧写入期间 Beast 的写操作会被推迟，
+// 反之亦然，从而不会破坏帧边界，也不会在同一个 socket 上同时挂起两个写操作。
+//
+// 流使用 io_context 的具体执行器，而不是 beast::tcp_stream 的多态 any_io_executor：
+// 后者每次完成回调都要经由一个另行申请内存的函数对象，无法使用处理器关联的分配器。
+//
+// 以 use_uring 指定事件循环的 io_uring 之后，读写都改为向它提交 recvmsg / sendmsg 请求，
+// 操作对象（含处理器）同样从处理器关联的分配器申请；挂起的请求在 close、cancel 与 teardown 时取消。
+class FrameStream {
+public:
+    using executor_type = boost::asio::io_context::executor_type;
+    using socket_type = boost::asio::basic_stream_socket<boost::asio::ip::tcp, executor_type>;
+    using stream_type = beast::basic_stream<boost::asio::ip::tcp, executor_type, beast::unlimited_rate_policy>;
+
+private:
+    stream_type stream_;                              // 实际的 TCP 流
+    bool raw_writing_ = false;                        // 是否有原始帧写入正在进行
+    bool beast_writing_ = false;                      // 是否有 Beast 发起的写操作正在进行
+    std::function<void()> deferred_raw_;              // 等待 Beast 写完后再开始的原始帧写入
+    std::function<void()> deferred_beast_;            // 等待原始帧写完后再开始的 Beast 写操作
+    uring::Loop* uring_ = nullptr;                    // io_uring 后端，为空时经由 tcp_stream（epoll）读写
+    uring::Operation* uring_read_ = nullptr;          // 挂起的 io_uring 读请求
+    uring::Operation* uring_write_ = nullptr;         // 挂起的 io_uring 写请求
+
+    template<class Handler, bool Write>
+    class UringOp;
+
+    // io_uring 模式下原始帧的写入目标，供 net::async_write 逐次调用 async_write_some
+    struct UringWriter {
+        FrameStream* self;
+
+        using executor_type = FrameStream::executor_type;
+
+        executor_type get_executor() noexcept {
+            return self->get_executor();
+        }
+
+        template<class ConstBufferSequence, class WriteHandler>
+        void async_write_some(ConstBufferSequence const& buffers, WriteHandler&& handler) {
+            self->start_uring<true>(buffers, std::forward<WriteHandler>(handler));
+        }
+    };
+    UringWriter uring_writer_{this};
+
+public:
+    explicit FrameStream(socket_type&& socket)
+        : stream_(std::move(socket)) {}
+
+    executor_type get_executor() noexcept {
+        return stream_.get_executor();
+    }
+
+    // 供 beast::get_lowest_layer 逐层查找最底层的流
+    stream_type& next_layer() noexcept {
+        return stream_;
+    }
+
+    stream_type const& next_layer() const noexcept {
+        return stream_;
+    }
+
+    // 之后的读写改用 loop 的 io_uring；只能在发起任何读写之前调用
+    void use_uring(uring::Loop* loop) noexcept {
+        uring_ = loop;
+    }
+
+    // 取消挂起的 io_uring 请求，它们随后以 operation_aborted 完成；epoll 模式下什么也不做
+    void cancel() {
+        if(uring_read_) {
+            uring_->cancel(uring_read_);
+        }
+        if(uring_write_) {
+            uring_->cancel(uring_write_);
+        }
+    }
+
+    // 关闭 socket，挂起的读写都以错误结束
+    // io_uring 持有文件的引用，只关闭描述符不会结束它的请求，因此先取消
+    void close(beast::error_code& ec) {
+        cancel();
+        stream_.socket().close(ec);
+    }
+
+    // 读操作转发给 tcp_stream 或 io_uring
+    template<class MutableBufferSequence, class ReadHandler>
+    auto async_read_some(MutableBufferSequence const& buffers, ReadHandler&& handler) {
+        return boost::asio::async_initiate<ReadHandler, void(beast::error_code, std::size_t)>(
+            [this](auto handler, MutableBufferSequence const& buffers) {
+                if(uring_) {
+                    start_uring<false>(buffers, std::move(handler));
+                } else {
+                    stream_.async_read_some(buffers, std::move(handler));
+                }
+            },
+            handler, buffers);
+    }
+
+    // Beast 内部的写操作（握手响应、控制帧），原始帧写入期间会被推迟
+    template<class ConstBufferSequence, class WriteHandler>
+    auto async_write_some(ConstBufferSequence const& buffers, WriteHandler&& handler) {
+        return boost::asio::async_initiate<WriteHandler, void(beast::error_code, std::size_t)>(
+            [this](auto handler, ConstBufferSequence const& buffers) {
+                if(raw_writing_) {
+                    // std::function 要求可拷贝，而 Beast 的处理器只能移动，
+                    // 因此用 shared_ptr 包一层；这只发生在罕见的控制帧冲突上
+                    auto h = std::make_shared<decltype(handler)>(std::move(handler));
+                    deferred_beast_ = [this, buffers, h]() {
+                        start_beast_write(buffers, std::move(*h));
+                    };
+                    return;
+                }
+                start_beast_write(buffers, std::move(handler));
+            },
+            handler, buffers);
+    }
+
+    // 写入一段完整的原始帧数据，handler 签名为 void(error_code, std::size_t)
+    // 调用方需保证同一时刻最多只有一个原始帧写入
+    template<class ConstBufferSequence, class WriteHandler>
+    void async_write_frames(ConstBufferSequence const& buffers, WriteHandler&& handler) {
+        if(beast_writing_) {
+            deferred_raw_ = [this, buffers, handler = std::forward<WriteHandler>(handler)]() mutable {
+                start_raw_write(buffers, std::move(handler));
+            };
+            return;
+        }
+        start_raw_write(buffers, std::forward<WriteHandler>(handler));
+    }
+
+private:
+    // 内部操作包装了调用方的处理器，需要把处理器关联的分配器带上，否则操作状态改由默认分配器申请
+    template<class ConstBufferSequence, class WriteHandler>
+    void start_beast_write(ConstBufferSequence const& buffers, WriteHandler&& handler) {
+        beast_writing_ = true;
+        auto const allocator = boost::asio::get_associated_allocator(handler);
+        write_some(
+            buffers,
+            bind_allocator(allocator, [this, handler = std::forward<WriteHandler>(handler)](
+                beast::error_code ec, std::size_t bytes_transferred) mutable {
+                beast_writing_ = false;
+
+                // 等待中的原始帧写入持有会话的引用，此时 this 一定仍然有效
+                bool const resume_raw = static_cast<bool>(deferred_raw_);
+                std::move(handler)(ec, bytes_transferred);
+
+                // Beast 的组合写操作会在回调中立即发起下一次 write_some，
+                // 只有它真正写完之后才轮到原始帧
+                if(resume_raw && !beast_writing_ && deferred_raw_) {
+                    auto next = std::move(deferred_raw_);
+                    deferred_raw_ = nullptr;
+                    next();
+                }
+            }));
+    }
+
+    template<class ConstBufferSequence, class WriteHandler>
+    void start_raw_write(ConstBufferSequence const& buffers, WriteHandler&& handler) {
+        raw_writing_ = true;
+        auto const allocator = boost::asio::get_associated_allocator(handler);
+        auto done = bind_allocator(allocator, [this, handler = std::forward<WriteHandler>(handler)](
+            beast::error_code ec, std::size_t bytes_transferred) mutable {
+            raw_writing_ = false;
+
+            // 先恢复被推迟的控制帧，让它排在下一条原始帧之前
+            if(deferred_beast_) {
+                auto next = std::move(deferred_beast_);
+                deferred_beast_ = nullptr;
+                next();
+            }
+            std::move(handler)(ec, bytes_transferred);
+        });
+        if(uring_) {
+            boost::asio::async_write(uring_writer_, buffers, std::move(done));
+        } else {
+            boost::asio::async_write(stream_, buffers, std::move(done));
+        }
+    }
+
+    // 单次写入，转发给 tcp_stream 或 io_uring
+    template<class ConstBufferSequence, class WriteHandler>
+    void write_some(ConstBufferSequence const& buffers, WriteHandler&& handler) {
+        if(uring_) {
+            start_uring<true>(buffers, std::forward<WriteHandler>(handler));
+        } else {
+            stream_.async_write_some(buffers, std::forward<WriteHandler>(handler));
+        }
+    }
+
+    // 向 io_uring 提交一次读或写；操作对象从处理器关联的分配器申请
+    template<bool Write, class BufferSequence, class Handler>
+    void start_uring(BufferSequence const& buffers, Handler&& handler) {
+        using Op = UringOp<std::decay_t<Handler>, Write>;
+        using Alloc = typename std::allocator_traits<
+            boost::asio::associated_allocator_t<std::decay_t<Handler>>>::template rebind_alloc<Op>;
+        Alloc alloc(boost::asio::get_associated_allocator(handler));
+        auto* op = std::allocator_traits<Alloc>::allocate(alloc, 1);
+        new(op) Op(*this, std::forward<Handler>(handler), buffers);
+        if(op->empty()) {
+            // 与 Asio 一样，零长度的读写立即以 0 字节完成，但不在发起函数内调用处理器
+            boost::asio::post(get_executor(), [op] { op->complete(0, 0); });
+            return;
+        }
+        if(Write) {
+            uring_write_ = op;
+            uring_->sendmsg(stream_.socket().native_handle(), op->message(), op);
+        } else {
+            uring_read_ = op;
+            uring_->recvmsg(stream_.socket().native_handle(), op->message(), op);
+        }
+    }
+};
+
+// 一次 io_uring 读或写：保存处理器与 iovec，完成后先释放自身再调用处理器，
+// 处理器因此可以立即发起下一次读写并复用同一块内存
+template<class Handler, bool Write>
+class FrameStream::UringOp final : public uring::Operation {
+    static constexpr std::size_t max_buffers = 64;    // 单次最多的缓冲区数，与 Asio 的 epoll 实现相同
+
+    FrameStream& stream_;
+    Handler handler_;
+    ::iovec iov_[max_buffers];
+    ::msghdr message_{};
+    std::size_t size_ = 0;                            // 各缓冲区的总字节数
+
+public:
+    template<class BufferSequence>
+    UringOp(FrameStream& stream, Handler&& handler, BufferSequence const& buffers)
+        : stream_(stream), handler_(std::move(handler)) {
+        std::size_t count = 0;
+        for(auto it = boost::asio::buffer_sequence_begin(buffers);
+            it != boost::asio::buffer_sequence_end(buffers) && count < max_buffers; ++it) {
+            boost::asio::const_buffer const b(*it);
+            if(b.size() == 0) {
+                continue;
+            }
+            iov_[count].iov_base = const_cast<void*>(b.data());
+            iov_[count].iov_len = b.size();
+            size_ += b.size();
+            ++count;
+        }
+        message_.msg_iov = iov_;
+        message_.msg_iovlen = count;
+    }
+
+    bool empty() const noexcept {
+        return size_ == 0;
+    }
+
+    ::msghdr* message() noexcept {
+        return &message_;
+    }
+
+    void complete(int result, unsigned) override {
+        (Write ? stream_.uring_write_ : stream_.uring_read_) = nullptr;
+
+        beast::error_code ec;
+        std::size_t bytes = 0;
+        if(result == -ECANCELED) {
+            ec = boost::asio::error::operation_aborted;
+        } else if(result < 0) {
+            ec.assign(-result, boost::system::system_category());
+        } else if(result == 0 && !Write && size_ > 0) {
+            ec = boost::asio::error::eof;
+        } else {
+            bytes = static_cast<std::size_t>(result);
+        }
+
+        auto handler = std::move(handler_);
+        auto const executor = boost::asio::get_associated_executor(handler, stream_.get_executor());
+        using Alloc = typename std::allocator_traits<
+            boost::asio::associated_allocator_t<Handler>>::template rebind_alloc<UringOp>;
+        Alloc alloc(boost::asio::get_associated_allocator(handler));
+        this->~UringOp();
+        std::allocator_traits<Alloc>::deallocate(alloc, this, 1);
+
+        // 完成总是在事件循环线程上取出，dispatch 直接调用处理器
+        boost::asio::dispatch(executor, beast::bind_front_handler(std::move(handler), ec, bytes));
+    }
+};
+
+// WebSocket 关闭握手结束后由 Beast 调用，转发给 tcp_stream 的实现
+// teardown 经由 tcp_stream 读写并关闭 socket，先取消 io_uring 上挂起的请求
+inline void teardown(
+    beast::role_type role,
+    FrameStream& stream,
+    beast::error_code& ec) {
+    using beast::websocket::teardown;
+    stream.cancel();
+    teardown(role, stream.next_layer(), ec);
+}
+
+template<class TeardownHandler>
+void async_teardown(
+    beast::role_type role,
+    FrameStream& stream,
+    TeardownHandler&& handler) {
+    using beast::websocket::async_teardown;
+    stream.cancel();
+    async_teardown(role, stream.next_layer(), std::forward<TeardownHandler>(handler));
+}
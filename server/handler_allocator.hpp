@@ -0,0 +1,200 @@
+#pragma once
+
+#include <boost/asio/associated_allocator.hpp>  // 处理器关联的分配器
+#include <boost/asio/associated_executor.hpp>   // 转发处理器关联的执行器
+#include <boost/asio/async_result.hpp>  // 完成令牌的定制点
+#include <cstddef>                       // std::size_t
+#include <new>                           // operator new / delete
+#include <type_traits>                   // std::decay_t
+#include <utility>                       // std::move, std::forward
+
+// 会话的处理器内存
+//
+// Asio 每发起一个异步操作都要为操作对象（其中包含处理器）申请一块内存，操作完成、调用处理器之前归还。
+// 一个会话同时挂起的操作很少（读、写、Beast 的定时器与控制帧），且每种操作的大小固定，
+// 因此每个会话保留几块内存即可让稳定状态下的读写不再调用 malloc。
+//
+// 内存块在第一次使用时按需申请，之后留给同样大小或更小的操作重复使用；
+// 全部槽位都在使用时退回堆分配。只能在会话所属事件循环的线程上使用，不加锁。
+class HandlerMemory {
+    static constexpr std::size_t slot_count = 4;      // 槽位数，对应同时挂起的操作数
+    static constexpr std::size_t granularity = 64;    // 块大小向上取整的粒度
+
+    struct Slot {
+        void* block = nullptr;                        // 已申请的内存块
+        std::size_t size = 0;                         // 内存块大小
+        bool in_use = false;                          // 是否正被某个操作使用
+    };
+
+    Slot slots_[slot_count];
+
+public:
+    HandlerMemory() = default;
+    HandlerMemory(HandlerMemory const&) = delete;
+    HandlerMemory& operator=(HandlerMemory const&) = delete;
+
+    ~HandlerMemory() {
+        for(auto& slot : slots_) {
+            ::operator delete(slot.block);
+        }
+    }
+
+    void* allocate(std::size_t size) {
+        // 优先复用足够大的空闲块；没有时替换一个空闲槽位中最小的块
+        Slot* replace = nullptr;
+        for(auto& slot : slots_) {
+            if(slot.in_use) {
+                continue;
+            }
+            if(slot.size >= size) {
+                slot.in_use = true;
+                return slot.block;
+            }
+            if(!replace || slot.size < replace->size) {
+                replace = &slot;
+            }
+        }
+        if(!replace) {
+            return ::operator new(size);
+        }
+
+        auto const rounded = (size + granularity - 1) / granularity * granularity;
+        void* block = ::operator new(rounded);
+        ::operator delete(replace->block);
+        replace->block = block;
+        replace->size = rounded;
+        replace->in_use = true;
+        return block;
+    }
+
+    void deallocate(void* pointer) noexcept {
+        for(auto& slot : slots_) {
+            if(slot.block == pointer) {
+                slot.in_use = false;
+                return;
+            }
+        }
+        ::operator delete(pointer);
+    }
+};
+
+// 从 HandlerMemory 分配的标准分配器，作为处理器的关联分配器交给 Asio
+template<class T>
+class HandlerAllocator {
+    template<class> friend class HandlerAllocator;
+
+    HandlerMemory* memory_;
+
+public:
+    using value_type = T;
+
+    explicit HandlerAllocator(HandlerMemory& memory) noexcept
+        : memory_(&memory) {}
+
+    template<class U>
+    HandlerAllocator(HandlerAllocator<U> const& other) noexcept
+        : memory_(other.memory_) {}
+
+    T* allocate(std::size_t n) {
+        return static_cast<T*>(memory_->allocate(sizeof(T) * n));
+    }
+
+    void deallocate(T* pointer, std::size_t) noexcept {
+        memory_->deallocate(pointer);
+    }
+
+    template<class U>
+    bool operator==(HandlerAllocator<U> const& other) const noexcept {
+        return memory_ == other.memory_;
+    }
+
+    template<class U>
+    bool operator!=(HandlerAllocator<U> const& other) const noexcept {
+        return memory_ != other.memory_;
+    }
+};
+
+// 给处理器附加一个关联分配器，其余行为（调用、关联的执行器）与原处理器相同
+template<class Allocator, class Handler>
+class AllocatorBinder {
+    Allocator allocator_;
+    Handler handler_;
+
+public:
+    using allocator_type = Allocator;
+
+    AllocatorBinder(Allocator const& allocator, Handler handler)
+        : allocator_(allocator), handler_(std::move(handler)) {}
+
+    allocator_type get_allocator() const noexcept {
+        return allocator_;
+    }
+
+    Handler const& handler() const noexcept {
+        return handler_;
+    }
+
+    template<class... Args>
+    void operator()(Args&&... args) {
+        handler_(std::forward<Args>(args)...);
+    }
+};
+
+namespace boost {
+namespace asio {
+
+template<class Allocator, class Handler, class Executor>
+struct associated_executor<AllocatorBinder<Allocator, Handler>, Executor> {
+    using type = associated_executor_t<Handler, Executor>;
+
+    static type get(AllocatorBinder<Allocator, Handler> const& h, Executor const& ex = Executor()) noexcept {
+        return associated_executor<Handler, Executor>::get(h.handler(), ex);
+    }
+};
+
+} // namespace asio
+} // namespace boost
+
+// 给完成令牌（例如 use_awaitable）附加关联分配器：令牌生成的处理器再经 bind_allocator 包装，
+// 操作状态因此从 allocator 分配。用于拿不到处理器对象本身的场合
+template<class Allocator, class Token>
+struct AllocatorToken {
+    Allocator allocator;
+    Token token;
+};
+
+namespace boost {
+namespace asio {
+
+template<class Allocator, class Token, class Signature>
+struct async_result<AllocatorToken<Allocator, Token>, Signature> {
+    using return_type = typename async_result<Token, Signature>::return_type;
+
+    template<class Initiation, class RawToken, class... Args>
+    static return_type initiate(Initiation&& initiation, RawToken&& token, Args&&... args) {
+        return async_initiate<Token const&, Signature>(
+            [initiation = std::forward<Initiation>(initiation), allocator = token.allocator](
+                auto&& handler, auto&&... args) mutable {
+                std::move(initiation)(
+                    AllocatorBinder<Allocator, std::decay_t<decltype(handler)>>(
+                        allocator, std::forward<decltype(handler)>(handler)),
+                    std::forward<decltype(args)>(args)...);
+            },
+            token.token, std::forward<Args>(args)...);
+    }
+};
+
+} // namespace asio
+} // namespace boost
+
+// 让 handler 的操作状态从 allocator 分配
+template<class Allocator, class Handler>
+AllocatorBinder<Allocator, std::decay_t<Handler>> bind_allocator(Allocator const& allocator, Handler&& handler) {
+    return {allocator, std::forward<Handler>(handler)};
+}
+
+// 让 handler 的操作状态从会话的处理器内存分配
+template<class Handler>
+AllocatorBinder<HandlerAllocator<void>, std::decay_t<Handler>> bind_memory(HandlerMemory& memory, Handler&& handler) {
+    return {HandlerAllocator<void>(memory), std::forward<Handler>(handler)};
+}
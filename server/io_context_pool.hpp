@@ -0,0 +1,87 @@
+#pragma once
+
+#include <boost/asio/executor_work_guard.hpp>  // 保持事件循环在空闲时不退出
+#include <boost/asio/io_context.hpp>     // I/O 上下文
+#include <cstddef>                       // std::size_t
+#include <memory>                        // 智能指针支持
+#include <thread>                        // 多线程支持
+#include <vector>                        // std::vector 容器
+
+// 事件循环池：每个线程独占一个 io_context
+//
+// 每个会话在创建时被分配到一个事件循环，之后它的全部异步操作都在该循环的线程上执行，
+// 因此会话内部的状态无需加锁；跨循环的交互只能通过向目标循环投递任务完成
+class IoContextPool {
+    using work_guard = boost::asio::executor_work_guard<boost::asio::io_context::executor_type>;
+
+    std::vector<std::unique_ptr<boost::asio::io_context>> contexts_;  // 每个循环一个 io_context
+    std::vector<work_guard> guards_;                  // 防止循环在没有任务时提前返回
+    std::vector<std::thread> threads_;                // 除调用线程以外的循环线程
+    std::size_t next_ = 0;                            // 轮询分配的下一个循环
+
+public:
+    // 构造函数：创建 size 个事件循环，至少为 1
+    explicit IoContextPool(std::size_t size) {
+        if(size == 0) {
+            size = 1;
+        }
+        contexts_.reserve(size);
+        guards_.reserve(size);
+        for(std::size_t i = 0; i < size; ++i) {
+            // 每个 io_context 只会被一个线程运行，以并发提示告知 Asio
+            contexts_.push_back(std::make_unique<boost::asio::io_context>(1));
+            guards_.push_back(boost::asio::make_work_guard(*contexts_.back()));
+        }
+    }
+
+    IoContextPool(IoContextPool const&) = delete;
+    IoContextPool& operator=(IoContextPool const&) = delete;
+
+    ~IoContextPool() {
+        stop();
+        join();
+    }
+
+    // 事件循环数量
+    std::size_t size() const noexcept {
+        return contexts_.size();
+    }
+
+    // 按下标取得事件循环
+    boost::asio::io_context& get(std::size_t index) noexcept {
+        return *contexts_[index];
+    }
+
+    // 轮询选择下一个事件循环的下标，只应在接受连接的线程上调用
+    std::size_t next() noexcept {
+        auto const index = next_;
+        next_ = (next_ + 1) % contexts_.size();
+        return index;
+    }
+
+    // 在后台线程上运行循环 1..N-1，在调用线程上运行循环 0，直到 stop() 被调用
+    void run() {
+        for(std::size_t i = 1; i < contexts_.size(); ++i) {
+            threads_.emplace_back([this, i] { contexts_[i]->run(); });
+        }
+        contexts_[0]->run();
+        join();
+    }
+
+    // 停止所有事件循环
+    void stop() {
+        for(auto& ctx : contexts_) {
+            ctx->stop();
+        }
+    }
+
+private:
+    void join() {
+        for(auto& t : threads_) {
+            if(t.joinable()) {
+                t.join();
+            }
+        }
+        threads_.clear();
+    }
+};
@@ -0,0 +1,342 @@
+#pragma once
+
+#include <algorithm>                     // std::min
+#include <atomic>                        // 原子变量
+#include <chrono>                        // 时间戳
+#include <cstddef>                       // std::size_t
+#include <cstdint>                       // 定长整数类型
+#include <cstdio>                        // std::fwrite、std::fflush
+#include <ctime>                         // localtime_r
+#include <memory>                        // 智能指针支持
+#include <mutex>                         // 互斥量支持
+#include <ostream>                       // std::ostream
+#include <streambuf>                     // 自定义 streambuf
+#include <thread>                        // 后台写线程
+#include <vector>                        // std::vector 容器
+
+// 异步日志
+//
+// - 每个线程一个单生产者/单消费者的无锁环形缓冲区，日志语句只把格式化好的文本写入本线程的环，
+//   不做任何终端或文件 I/O，也不获取任何锁（只有线程第一次写日志时登记环需要加锁）
+// - 一个后台线程轮询全部环，批量写到 stdout（warn 及以上写到 stderr）
+// - 环满时丢弃新日志并计数，事件循环永远不会因日志阻塞
+// - 日志级别低于阈值时，LOG_* 宏只做一次原子读，不会对参数求值
+// - LOG_SAMPLED 每 N 条只记录 1 条，用于逐消息的热路径日志
+//
+// 用法：LOG_INFO << "新客户端连接，总客户端数: " << count;
+namespace logging {
+
+enum class Level : std::uint8_t {
+    debug,
+    info,
+    warn,
+    error,
+    off
+};
+
+namespace detail {
+
+// 单条日志记录，定长以便环形缓冲区预先分配，超出部分被截断
+struct Record {
+    static constexpr std::size_t capacity = 232;
+
+    std::chrono::system_clock::time_point time;       // 记录时间
+    Level level;                                      // 日志级别
+    std::uint16_t size;                               // text 中的有效字节数
+    char text[capacity];                              // 日志文本，不含换行
+};
+
+// 单生产者/单消费者环形缓冲区：生产者是写日志的线程，消费者是后台写线程
+class Ring {
+public:
+    static constexpr std::size_t capacity = 1024;     // 必须是 2 的幂
+
+private:
+    alignas(64) std::atomic<std::size_t> head_{0};    // 消费者读取位置
+    alignas(64) std::atomic<std::size_t> tail_{0};    // 生产者写入位置
+    alignas(64) std::atomic<bool> retired_{false};    // 生产者线程已退出
+    std::unique_ptr<Record[]> records_{new Record[capacity]};
+
+public:
+    // 生产者：取得下一个空闲记录，环满时返回空指针
+    Record* reserve() noexcept {
+        auto const tail = tail_.load(std::memory_order_relaxed);
+        if(tail - head_.load(std::memory_order_acquire) >= capacity) {
+            return nullptr;
+        }
+        return &records_[tail & (capacity - 1)];
+    }
+
+    // 生产者：发布 reserve 取得的记录
+    void commit() noexcept {
+        tail_.store(tail_.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+    // 消费者：依次处理全部已发布的记录，返回处理条数
+    template<class Function>
+    std::size_t drain(Function&& fn) {
+        auto head = head_.load(std::memory_order_relaxed);
+        auto const tail = tail_.load(std::memory_order_acquire);
+        for(auto i = head; i != tail; ++i) {
+            fn(records_[i & (capacity - 1)]);
+        }
+        head_.store(tail, std::memory_order_release);
+        return tail - head;
+    }
+
+    void retire() noexcept {
+        retired_.store(true, std::memory_order_release);
+    }
+
+    bool retired() const noexcept {
+        return retired_.load(std::memory_order_acquire);
+    }
+};
+
+// 把 ostream 的输出写进一条定长记录，写满后静默截断
+class RecordBuf : public std::streambuf {
+public:
+    void reset(char* begin, std::size_t size) {
+        setp(begin, begin + size);
+    }
+
+    std::size_t size() const noexcept {
+        return static_cast<std::size_t>(pptr() - pbase());
+    }
+
+protected:
+    int_type overflow(int_type ch) override {
+        return traits_type::not_eof(ch);
+    }
+};
+
+} // namespace detail
+
+// 日志器：全局唯一，持有全部线程的环形缓冲区和后台写线程
+class Logger {
+    std::atomic<Level> level_{Level::info};           // 当前级别阈值
+    std::atomic<std::uint32_t> sample_{1};            // LOG_SAMPLED 的采样间隔
+    std::atomic<std::uint64_t> dropped_{0};           // 因环满丢弃的日志条数
+    std::mutex mutex_;                                // 保护 rings_，只在登记新线程和后台线程取列表时使用
+    std::vector<std::shared_ptr<detail::Ring>> rings_;  // 全部线程的环
+    std::atomic<bool> running_{false};                // 后台写线程是否在运行
+    std::thread writer_;                              // 后台写线程
+
+public:
+    static Logger& instance() {
+        static Logger logger;
+        return logger;
+    }
+
+    ~Logger() {
+        stop();
+    }
+
+    void set_level(Level level) noexcept {
+        level_.store(level, std::memory_order_relaxed);
+    }
+
+    void set_sample(std::uint32_t every) noexcept {
+        sample_.store(every > 0 ? every : 1, std::memory_order_relaxed);
+    }
+
+    bool enabled(Level level) const noexcept {
+        return level >= level_.load(std::memory_order_relaxed);
+    }
+
+    std::uint32_t sample() const noexcept {
+        return sample_.load(std::memory_order_relaxed);
+    }
+
+    std::uint64_t dropped() const noexcept {
+        return dropped_.load(std::memory_order_relaxed);
+    }
+
+    // 启动后台写线程；在 start 之前写入的日志会在启动后输出
+    void start() {
+        if(running_.exchange(true)) {
+            return;
+        }
+        writer_ = std::thread([this] { write_loop(); });
+    }
+
+    // 停止后台写线程，并把剩余的日志全部输出
+    void stop() {
+        if(!running_.exchange(false)) {
+            return;
+        }
+        writer_.join();
+        flush_all();
+    }
+
+    // 取得当前线程的环，第一次调用时登记
+    detail::Ring& local_ring() {
+        // 线程退出时标记环为已退出，由后台线程输出剩余日志后释放
+        struct Holder {
+            std::shared_ptr<detail::Ring> ring;
+            ~Holder() {
+                if(ring) {
+                    ring->retire();
+                }
+            }
+        };
+        thread_local Holder holder;
+        if(!holder.ring) {
+            holder.ring = std::make_shared<detail::Ring>();
+            std::lock_guard<std::mutex> lock(mutex_);
+            rings_.push_back(holder.ring);
+        }
+        return *holder.ring;
+    }
+
+    void count_dropped() noexcept {
+        dropped_.fetch_add(1, std::memory_order_relaxed);
+    }
+
+private:
+    Logger() = default;
+
+    void write_loop() {
+        while(running_.load(std::memory_order_acquire)) {
+            if(flush_all() == 0) {
+                // 空闲时短暂休眠；日志只求尽快输出，不要求实时
+                std::this_thread::sleep_for(std::chrono::milliseconds(5));
+            }
+        }
+    }
+
+    // 输出全部环中的日志，返回输出条数
+    std::size_t flush_all() {
+        std::vector<std::shared_ptr<detail::Ring>> rings;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            rings = rings_;
+        }
+
+        std::size_t written = 0;
+        bool wrote_err = false;
+        for(auto const& ring : rings) {
+            bool const retired = ring->retired();
+            written += ring->drain([&](detail::Record const& r) {
+                auto* out = r.level >= Level::warn ? stderr : stdout;
+                wrote_err = wrote_err || out == stderr;
+                write_record(out, r);
+            });
+            if(retired) {
+                // 线程已退出且剩余日志已输出，释放它的环
+                std::lock_guard<std::mutex> lock(mutex_);
+                rings_.erase(std::remove(rings_.begin(), rings_.end(), ring), rings_.end());
+            }
+        }
+
+        auto const dropped = dropped_.exchange(0, std::memory_order_relaxed);
+        if(dropped > 0) {
+            std::fprintf(stderr, "[日志] 因缓冲区已满丢弃 %llu 条日志\n",
+                static_cast<unsigned long long>(dropped));
+            wrote_err = true;
+        }
+
+        if(written > 0) {
+            std::fflush(stdout);
+        }
+        if(wrote_err) {
+            std::fflush(stderr);
+        }
+        return written;
+    }
+
+    static void write_record(std::FILE* out, detail::Record const& r) {
+        static char const* const names[] = {"DEBUG", "INFO", "WARN", "ERROR", "OFF"};
+
+        auto const t = std::chrono::system_clock::to_time_t(r.time);
+        auto const ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+            r.time.time_since_epoch()).count() % 1000;
+        std::tm tm{};
+        localtime_r(&t, &tm);
+
+        char prefix[48];
+        auto const n = std::snprintf(prefix, sizeof(prefix), "%02d:%02d:%02d.%03d %-5s ",
+            tm.tm_hour, tm.tm_min, tm.tm_sec, static_cast<int>(ms),
+            names[static_cast<int>(r.level)]);
+        std::fwrite(prefix, 1, static_cast<std::size_t>(n), out);
+        std::fwrite(r.text, 1, r.size, out);
+        std::fputc('\n', out);
+    }
+};
+
+// 一条日志语句：构造时在本线程的环中预留记录，析构时发布
+// 环满时输出被丢弃到一个空的记录中，保证语句本身总能执行完
+class Line {
+    detail::Ring& ring_;
+    detail::Record* record_;
+    detail::Record overflow_;                         // 环满时的占位记录，内容会被丢弃
+
+    struct Stream {
+        detail::RecordBuf buf;
+        std::ostream os{&buf};
+    };
+
+    static Stream& local_stream() {
+        thread_local Stream stream;
+        return stream;
+    }
+
+public:
+    explicit Line(Level level)
+        : ring_(Logger::instance().local_ring()),
+          record_(ring_.reserve()) {
+        auto* r = record_ ? record_ : &overflow_;
+        r->time = std::chrono::system_clock::now();
+        r->level = level;
+        local_stream().buf.reset(r->text, detail::Record::capacity);
+    }
+
+    ~Line() {
+        if(!record_) {
+            Logger::instance().count_dropped();
+            return;
+        }
+        record_->size = static_cast<std::uint16_t>(
+            std::min(local_stream().buf.size(), detail::Record::capacity));
+        ring_.commit();
+    }
+
+    Line(Line const&) = delete;
+    Line& operator=(Line const&) = delete;
+
+    std::ostream& stream() noexcept {
+        return local_stream().os;
+    }
+};
+
+inline bool enabled(Level level) noexcept {
+    return Logger::instance().enabled(level);
+}
+
+// 采样判断：counter 为调用点私有的线程局部计数
+inline bool sample_hit(std::uint32_t& counter) noexcept {
+    auto const every = Logger::instance().sample();
+    if(++counter >= every) {
+        counter = 0;
+        return true;
+    }
+    return false;
+}
+
+} // namespace logging
+
+#define LOG_AT(level) \
+    if(!::logging::enabled(level)) {} else ::logging::Line(level).stream()
+
+#define LOG_DEBUG LOG_AT(::logging::Level::debug)
+#define LOG_INFO  LOG_AT(::logging::Level::info)
+#define LOG_WARN  LOG_AT(::logging::Level::warn)
+#define LOG_ERROR LOG_AT(::logging::Level::error)
+
+// 按 --log-sample 采样的 info 日志，用于逐消息的热路径
+#define LOG_SAMPLED \
+    if(!::logging::enabled(::logging::Level::info) || \
+       !::logging::sample_hit([]() -> std::uint32_t& { \
+           static thread_local std::uint32_t counter = 0; \
+           return counter; }())) {} \
+    else ::logging::Line(::logging::Level::info).stream()
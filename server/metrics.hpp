@@ -0,0 +1,416 @@
+#pragma once
+
+#include <array>                         // 定长数组
+#include <atomic>                        // 原子变量
+#include <cstddef>                       // std::size_t
+#include <cstdint>                       // 定长整数类型
+#include <cstdio>                        // std::snprintf
+#include <functional>                    // std::function
+#include <memory>                        // 智能指针支持
+#include <mutex>                         // 互斥量支持
+#include <string>                        // std::string 支持
+#include <utility>                       // std::move
+#include <vector>                        // std::vector 容器
+
+// 服务器指标，以 Prometheus 文本格式导出
+//
+// - 每个线程有自己的一组计数器、仪表与直方图，只由本线程写入（普通的 relaxed 读改写，
+//   没有 lock 前缀的原子指令，也没有跨线程共享的缓存行），采集时才汇总全部线程
+// - 直方图为 HDR 风格的对数线性分桶：每个 2 的幂区间再均分为 8 个子桶，
+//   相对误差不超过 12.5%，覆盖全部 64 位取值，记录一次只是一次数组下标的自增
+// - 不按线程统计的值（在线连接数、房间数）以回调仪表的形式在采集时读取
+namespace metrics {
+
+// 单调递增的计数器
+enum class Counter : std::size_t {
+    connections_accepted,                             // 完成 WebSocket 握手的连接数
+    connections_closed,                               // 已断开的连接数
+    handshake_failures,                               // HTTP 读取或 WebSocket 握手失败的连接数
+    messages_received,                                // 收到的消息数
+    bytes_received,                                   // 收到的消息负载字节数
+    messages_sent,                                    // 写出的消息（帧）数
+    bytes_sent,                                       // 写出的帧字节数
+    dropped_oldest,                                   // drop_oldest 丢弃的消息数
+    dropped_newest,                                   // drop_newest 丢弃的消息数
+    conflated,                                        // conflate 合并掉的消息数
+    slow_disconnects,                                 // disconnect 策略断开的连接数
+    dropped_bytes,                                    // 因背压丢弃的帧字节数
+    http_requests,                                    // 非升级的 HTTP 请求数
+    handshake_timeouts,                               // 未在期限内完成握手而关闭的连接数
+    idle_timeouts,                                    // 空闲超时而关闭的连接数
+    pings_sent,                                       // 发出的保活 ping 数
+    core_ring_overflows,                              // 无共享模式下核心间通道已满而丢弃的投递数
+    connections_steered,                              // 按接收 CPU 改派到其他事件循环的连接数
+    uring_submits,                                    // io_uring 后端的 io_uring_enter 提交次数
+    uring_requests,                                   // io_uring 后端提交的请求数
+    count_
+};
+
+// 可增可减的仪表，各线程的增量之和即为当前值
+enum class Gauge : std::size_t {
+    queued_messages,                                  // 全部发送队列中的消息数
+    queued_bytes,                                     // 全部发送队列中的帧字节数
+    read_buffers,                                     // 正在读取消息、借用着接收缓冲区的会话数
+    pooled_bytes,                                     // 各事件循环缓冲池中空闲内存块的总字节数
+    count_
+};
+
+// 直方图
+enum class Hist : std::size_t {
+    fanout_ns,                                        // 一次发布的扇出耗时（纳秒）
+    queue_depth,                                      // 入队后发送队列的消息数
+    inbox_batch,                                      // 跨循环收件箱每次唤醒取出的投递数
+    trace_dispatch_ns,                                // 追踪：读取完成 → 开始扇出
+    trace_enqueue_ns,                                 // 追踪：开始扇出 → 进入接收者队列
+    trace_write_ns,                                   // 追踪：进入接收者队列 → 写完
+    trace_total_ns,                                   // 追踪：读取完成 → 最后一个接收者写完
+    count_
+};
+
+namespace detail {
+
+struct CounterInfo {
+    char const* name;
+    char const* help;
+};
+
+inline CounterInfo const& info(Counter c) {
+    static CounterInfo const table[] = {
+        {"websocket_connections_accepted_total", "完成 WebSocket 握手的连接数"},
+        {"websocket_connections_closed_total", "已断开的连接数"},
+        {"websocket_handshake_failures_total", "HTTP 读取或 WebSocket 握手失败的连接数"},
+        {"websocket_messages_received_total", "收到的消息数"},
+        {"websocket_received_bytes_total", "收到的消息负载字节数"},
+        {"websocket_messages_sent_total", "写出的消息数"},
+        {"websocket_sent_bytes_total", "写出的帧字节数"},
+        {"websocket_backpressure_dropped_oldest_total", "drop-oldest 策略丢弃的消息数"},
+        {"websocket_backpressure_dropped_newest_total", "drop-newest 策略丢弃的消息数"},
+        {"websocket_backpressure_conflated_total", "conflate 策略合并掉的消息数"},
+        {"websocket_backpressure_disconnects_total", "disconnect 策略断开的连接数"},
+        {"websocket_backpressure_dropped_bytes_total", "因背压丢弃的帧字节数"},
+        {"http_requests_total", "非升级的 HTTP 请求数"},
+        {"websocket_handshake_timeouts_total", "未在期限内完成握手而关闭的连接数"},
+        {"websocket_idle_timeouts_total", "空闲超时而关闭的连接数"},
+        {"websocket_pings_sent_total", "发出的保活 ping 数"},
+        {"websocket_core_ring_overflows_total", "无共享模式下核心间通道已满而丢弃的投递数"},
+        {"websocket_connections_steered_total", "按 SO_INCOMING_CPU 改派到接收 CPU 上事件循环的连接数"},
+        {"websocket_uring_submits_total", "io_uring 后端的 io_uring_enter 提交次数"},
+        {"websocket_uring_requests_total", "io_uring 后端提交的读写与接受请求数"},
+    };
+    static_assert(sizeof(table) / sizeof(table[0]) == static_cast<std::size_t>(Counter::count_), "");
+    return table[static_cast<std::size_t>(c)];
+}
+
+inline CounterInfo const& info(Gauge g) {
+    static CounterInfo const table[] = {
+        {"websocket_queued_messages", "全部发送队列中的消息数"},
+        {"websocket_queued_bytes", "全部发送队列中的帧字节数"},
+        {"websocket_read_buffers", "正在读取消息、借用着接收缓冲区的会话数"},
+        {"websocket_buffer_pool_bytes", "各事件循环缓冲池中空闲内存块的总字节数"},
+    };
+    static_assert(sizeof(table) / sizeof(table[0]) == static_cast<std::size_t>(Gauge::count_), "");
+    return table[static_cast<std::size_t>(g)];
+}
+
+// 直方图的导出方式：记录值除以 scale 后输出，le 边界为 2^min_pow .. 2^max_pow
+struct HistInfo {
+    char const* name;
+    char const* help;
+    double scale;
+    unsigned min_pow;
+    unsigned max_pow;
+};
+
+inline HistInfo const& info(Hist h) {
+    static HistInfo const table[] = {
+        {"websocket_fanout_seconds", "一次发布的扇出耗时", 1e9, 8, 34},
+        {"websocket_queue_depth", "入队后发送队列的消息数", 1, 0, 16},
+        {"websocket_inbox_batch", "跨事件循环收件箱每次唤醒取出的投递数", 1, 0, 16},
+        {"websocket_trace_dispatch_seconds", "追踪：读取完成到开始扇出", 1e9, 8, 34},
+        {"websocket_trace_enqueue_seconds", "追踪：开始扇出到进入接收者发送队列", 1e9, 8, 34},
+        {"websocket_trace_write_seconds", "追踪：进入发送队列到写入 socket", 1e9, 8, 34},
+        {"websocket_trace_total_seconds", "追踪：读取完成到最后一个接收者写完", 1e9, 8, 34},
+    };
+    static_assert(sizeof(table) / sizeof(table[0]) == static_cast<std::size_t>(Hist::count_), "");
+    return table[static_cast<std::size_t>(h)];
+}
+
+// 单写者的 relaxed 自增：只有所属线程写入，采集线程只读
+inline void bump(std::atomic<std::uint64_t>& v, std::uint64_t n) noexcept {
+    v.store(v.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+}
+
+inline void bump(std::atomic<std::int64_t>& v, std::int64_t n) noexcept {
+    v.store(v.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+}
+
+} // namespace detail
+
+// 对数线性分桶的规则
+struct Buckets {
+    static constexpr unsigned sub_bits = 3;
+    static constexpr std::size_t sub_count = std::size_t(1) << sub_bits;
+    static constexpr std::size_t count = (64 - sub_bits + 1) * sub_count;
+
+    // 取值所在的桶
+    static std::size_t index(std::uint64_t v) noexcept {
+        if(v < sub_count) {
+            return static_cast<std::size_t>(v);
+        }
+        auto const msb = 63u - static_cast<unsigned>(__builtin_clzll(v));
+        auto const shift = msb - sub_bits;
+        return (shift + 1) * sub_count + static_cast<std::size_t>((v >> shift) & (sub_count - 1));
+    }
+
+    // 桶内的最大取值
+    static std::uint64_t upper(std::size_t i) noexcept {
+        if(i < sub_count) {
+            return i;
+        }
+        auto const shift = i / sub_count - 1;
+        auto const lower = (sub_count + i % sub_count) << shift;
+        return lower + ((std::uint64_t(1) << shift) - 1);
+    }
+};
+
+// 一个线程的直方图，只由所属线程写入
+class Histogram {
+    std::array<std::atomic<std::uint64_t>, Buckets::count> buckets_{};
+    std::atomic<std::uint64_t> count_{0};
+    std::atomic<std::uint64_t> sum_{0};
+
+public:
+    void record(std::uint64_t v) noexcept {
+        detail::bump(buckets_[Buckets::index(v)], 1);
+        detail::bump(count_, 1);
+        detail::bump(sum_, v);
+    }
+
+    friend class HistogramSnapshot;
+};
+
+// 汇总后的直方图
+class HistogramSnapshot {
+    std::array<std::uint64_t, Buckets::count> buckets_{};
+    std::uint64_t count_ = 0;
+    std::uint64_t sum_ = 0;
+
+public:
+    void merge(Histogram const& h) noexcept {
+        for(std::size_t i = 0; i < Buckets::count; ++i) {
+            buckets_[i] += h.buckets_[i].load(std::memory_order_relaxed);
+        }
+        count_ += h.count_.load(std::memory_order_relaxed);
+        sum_ += h.sum_.load(std::memory_order_relaxed);
+    }
+
+    std::uint64_t count() const noexcept {
+        return count_;
+    }
+
+    std::uint64_t sum() const noexcept {
+        return sum_;
+    }
+
+    // 取值不超过 limit 的记录数
+    std::uint64_t count_at_most(std::uint64_t limit) const noexcept {
+        std::uint64_t n = 0;
+        for(std::size_t i = 0; i < Buckets::count && Buckets::upper(i) <= limit; ++i) {
+            n += buckets_[i];
+        }
+        return n;
+    }
+
+    // 分位数 q ∈ [0, 1]，返回所在桶的上界；没有记录时返回 0
+    std::uint64_t quantile(double q) const noexcept {
+        if(count_ == 0) {
+            return 0;
+        }
+        auto const rank = static_cast<std::uint64_t>(q * static_cast<double>(count_ - 1)) + 1;
+        std::uint64_t seen = 0;
+        for(std::size_t i = 0; i < Buckets::count; ++i) {
+            seen += buckets_[i];
+            if(seen >= rank) {
+                return Buckets::upper(i);
+            }
+        }
+        return Buckets::upper(Buckets::count - 1);
+    }
+};
+
+// 一个线程的全部指标，独占缓存行
+struct alignas(64) ThreadMetrics {
+    std::array<std::atomic<std::uint64_t>, static_cast<std::size_t>(Counter::count_)> counters{};
+    std::array<std::atomic<std::int64_t>, static_cast<std::size_t>(Gauge::count_)> gauges{};
+    std::array<Histogram, static_cast<std::size_t>(Hist::count_)> histograms;
+};
+
+// 全部线程汇总后的指标
+struct Snapshot {
+    std::array<std::uint64_t, static_cast<std::size_t>(Counter::count_)> counters{};
+    std::array<std::int64_t, static_cast<std::size_t>(Gauge::count_)> gauges{};
+    std::array<HistogramSnapshot, static_cast<std::size_t>(Hist::count_)> histograms;
+
+    std::uint64_t operator[](Counter c) const noexcept {
+        return counters[static_cast<std::size_t>(c)];
+    }
+
+    std::int64_t operator[](Gauge g) const noexcept {
+        return gauges[static_cast<std::size_t>(g)];
+    }
+
+    HistogramSnapshot const& operator[](Hist h) const noexcept {
+        return histograms[static_cast<std::size_t>(h)];
+    }
+};
+
+// 指标注册表：全局唯一，登记每个线程的指标块以及采集时读取的回调仪表
+class Registry {
+    struct Callback {
+        std::string name;                             // 指标名
+        std::string help;                             // 说明
+        std::function<double()> read;                 // 采集时调用
+    };
+
+    mutable std::mutex mutex_;                        // 保护 threads_ 与 callbacks_，只在登记与采集时使用
+    std::vector<std::shared_ptr<ThreadMetrics>> threads_;  // 全部线程的指标块，线程退出后保留以免计数倒退
+    std::vector<Callback> callbacks_;                 // 回调仪表
+
+public:
+    static Registry& instance() {
+        static Registry registry;
+        return registry;
+    }
+
+    // 当前线程的指标块，第一次调用时登记
+    ThreadMetrics& local() {
+        thread_local std::shared_ptr<ThreadMetrics> block;
+        if(!block) {
+            block = std::make_shared<ThreadMetrics>();
+            std::lock_guard<std::mutex> lock(mutex_);
+            threads_.push_back(block);
+        }
+        return *block;
+    }
+
+    // 登记一个采集时读取的仪表；read 在采集线程上调用，需自行保证线程安全
+    void add_callback(std::string name, std::string help, std::function<double()> read) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        callbacks_.push_back(Callback{std::move(name), std::move(help), std::move(read)});
+    }
+
+    // 移除全部回调仪表（回调引用的对象销毁前调用）
+    void clear_callbacks() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        callbacks_.clear();
+    }
+
+    // 汇总全部线程的指标
+    Snapshot snapshot() const {
+        Snapshot s;
+        std::lock_guard<std::mutex> lock(mutex_);
+        for(auto const& t : threads_) {
+            for(std::size_t i = 0; i < s.counters.size(); ++i) {
+                s.counters[i] += t->counters[i].load(std::memory_order_relaxed);
+            }
+            for(std::size_t i = 0; i < s.gauges.size(); ++i) {
+                s.gauges[i] += t->gauges[i].load(std::memory_order_relaxed);
+            }
+            for(std::size_t i = 0; i < s.histograms.size(); ++i) {
+                s.histograms[i].merge(t->histograms[i]);
+            }
+        }
+        return s;
+    }
+
+    // 以 Prometheus 文本格式（0.0.4）输出全部指标
+    std::string render() const {
+        auto const s = snapshot();
+        std::string out;
+        out.reserve(8192);
+
+        for(std::size_t i = 0; i < s.counters.size(); ++i) {
+            auto const& d = detail::info(static_cast<Counter>(i));
+            write_header(out, d.name, d.help, "counter");
+            write_sample(out, d.name, "", static_cast<double>(s.counters[i]));
+        }
+        for(std::size_t i = 0; i < s.gauges.size(); ++i) {
+            auto const& d = detail::info(static_cast<Gauge>(i));
+            write_header(out, d.name, d.help, "gauge");
+            write_sample(out, d.name, "", static_cast<double>(s.gauges[i]));
+        }
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            for(auto const& c : callbacks_) {
+                write_header(out, c.name.c_str(), c.help.c_str(), "gauge");
+                write_sample(out, c.name.c_str(), "", c.read());
+            }
+        }
+        for(std::size_t i = 0; i < s.histograms.size(); ++i) {
+            write_histogram(out, detail::info(static_cast<Hist>(i)), s.histograms[i]);
+        }
+        return out;
+    }
+
+private:
+    Registry() = default;
+
+    static void write_header(std::string& out, char const* name, char const* help, char const* type) {
+        out += "# HELP ";
+        out += name;
+        out += ' ';
+        out += help;
+        out += "\n# TYPE ";
+        out += name;
+        out += ' ';
+        out += type;
+        out += '\n';
+    }
+
+    static void write_sample(std::string& out, char const* name, char const* suffix, double value,
+                             char const* le = nullptr) {
+        char number[64];
+        std::snprintf(number, sizeof(number), "%.17g", value);
+        out += name;
+        out += suffix;
+        if(le) {
+            out += "{le=\"";
+            out += le;
+            out += "\"}";
+        }
+        out += ' ';
+        out += number;
+        out += '\n';
+    }
+
+    // 对数线性桶按 2 的幂合并为 Prometheus 的累积桶，子桶不会跨越 2 的幂边界，合并是精确的
+    static void write_histogram(std::string& out, detail::HistInfo const& d, HistogramSnapshot const& h) {
+        write_header(out, d.name, d.help, "histogram");
+        char le[64];
+        for(unsigned p = d.min_pow; p <= d.max_pow; ++p) {
+            auto const bound = std::uint64_t(1) << p;
+            std::snprintf(le, sizeof(le), "%.12g", static_cast<double>(bound) / d.scale);
+            write_sample(out, d.name, "_bucket", static_cast<double>(h.count_at_most(bound - 1)), le);
+        }
+        write_sample(out, d.name, "_bucket", static_cast<double>(h.count()), "+Inf");
+        write_sample(out, d.name, "_sum", static_cast<double>(h.sum()) / d.scale);
+        write_sample(out, d.name, "_count", static_cast<double>(h.count()));
+    }
+};
+
+// 当前线程的计数器加 n
+inline void add(Counter c, std::uint64_t n = 1) {
+    detail::bump(Registry::instance().local().counters[static_cast<std::size_t>(c)], n);
+}
+
+// 当前线程的仪表增量
+inline void adjust(Gauge g, std::int64_t delta) {
+    detail::bump(Registry::instance().local().gauges[static_cast<std::size_t>(g)], delta);
+}
+
+// 向当前线程的直方图记录一个值
+inline void observe(Hist h, std::uint64_t v) {
+    Registry::instance().local().histograms[static_cast<std::size_t>(h)].record(v);
+}
+
+} // namespace metrics
@@ -0,0 +1,137 @@
+#pragma once
+
+#include <atomic>                        // 链表头
+#include <cstddef>                       // std::size_t
+#include <new>                           // ::operator new
+#include <utility>                       // std::move
+
+// 无锁的多生产者 / 单消费者收件箱
+//
+// 任意线程 push，只有收件箱所属事件循环的线程 drain。生产者用一次 CAS 把节点压入链表头，
+// 消费者用一次 exchange 把整条链表取走，反转后按入队顺序处理，双方都不加锁。
+// push 返回 true 表示收件箱原本为空：调用方应向消费者投递一次 drain；之后直到这一批被取走之前
+// 的 push 都返回 false，因此一批消息只唤醒消费者一次，且每一批都一定有一个待执行的 drain。
+//
+// 节点内存由线程局部的空闲链表回收：消费者处理完的节点留在消费线程，该线程下次 push 时直接复用。
+// 事件循环之间互相投递，节点在各循环之间往返，稳定之后 push 不再申请堆内存。
+template<class T>
+class MpscInbox {
+    struct Node {
+        Node* next;
+        T value;
+    };
+
+    static constexpr std::size_t max_cached = 1024;   // 每个线程最多保留的空闲节点数
+
+    // 线程局部的空闲节点链表，链接指针存放在节点内存的起始处
+    struct Cache {
+        struct Free {
+            Free* next;
+        };
+        Free* free = nullptr;
+        std::size_t count = 0;
+        bool alive = true;                            // 线程退出析构后不再缓存
+
+        ~Cache() {
+            alive = false;
+            while(free) {
+                auto* next = free->next;
+                ::operator delete(free);
+                free = next;
+            }
+        }
+    };
+
+    static Cache& cache() {
+        thread_local Cache c;
+        return c;
+    }
+
+    alignas(64) std::atomic<Node*> head_{nullptr};    // 最近压入的节点，为空表示收件箱为空
+
+public:
+    MpscInbox() = default;
+    MpscInbox(MpscInbox const&) = delete;
+    MpscInbox& operator=(MpscInbox const&) = delete;
+
+    // 丢弃尚未取出的元素
+    ~MpscInbox() {
+        release(head_.exchange(nullptr, std::memory_order_acquire));
+    }
+
+    // 任意线程调用：放入一个元素，返回收件箱原本是否为空
+    bool push(T value) {
+        auto* node = new(allocate()) Node{head_.load(std::memory_order_relaxed), std::move(value)};
+        while(!head_.compare_exchange_weak(node->next, node,
+                                           std::memory_order_release, std::memory_order_relaxed)) {
+        }
+        return node->next == nullptr;
+    }
+
+    // 消费者调用：取走当前的全部元素，按入队顺序逐个交给 fn，返回处理的个数
+    // fn 执行期间新放入的元素留给下一次 drain
+    template<class Function>
+    std::size_t drain(Function&& fn) {
+        auto* node = head_.exchange(nullptr, std::memory_order_acquire);
+
+        // 链表是后进先出的，反转一次恢复入队顺序
+        Node* ordered = nullptr;
+        while(node) {
+            auto* next = node->next;
+            node->next = ordered;
+            ordered = node;
+            node = next;
+        }
+
+        std::size_t count = 0;
+        while(ordered) {
+            auto* next = ordered->next;
+            try {
+                fn(ordered->value);
+            } catch(...) {
+                destroy(ordered);
+                release(next);
+                throw;
+            }
+            destroy(ordered);
+            ordered = next;
+            ++count;
+        }
+        return count;
+    }
+
+private:
+    // 取一个节点的内存，优先复用本线程的空闲节点
+    static void* allocate() {
+        auto& c = cache();
+        if(c.free) {
+            auto* memory = c.free;
+            c.free = memory->next;
+            --c.count;
+            return memory;
+        }
+        return ::operator new(sizeof(Node));
+    }
+
+    // 析构节点并把内存留给本线程，超出上限时归还堆
+    static void destroy(Node* node) noexcept {
+        node->~Node();
+        auto& c = cache();
+        if(c.alive && c.count < max_cached) {
+            auto* memory = reinterpret_cast<typename Cache::Free*>(node);
+            memory->next = c.free;
+            c.free = memory;
+            ++c.count;
+        } else {
+            ::operator delete(node);
+        }
+    }
+
+    static void release(Node* node) noexcept {
+        while(node) {
+            auto* next = node->next;
+            destroy(node);
+            node = next;
+        }
+    }
+};
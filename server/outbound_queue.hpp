@@ -0,0 +1,347 @@
+#pragma once
+
+#include "frame_buffer.hpp"              // 共享帧
+#include "metrics.hpp"                   // 背压与队列深度指标
+#include "trace.hpp"                     // 消息延迟追踪
+
+#include <boost/asio/buffer.hpp>         // net::const_buffer
+#include <chrono>                        // 入队时间与滞后阈值
+#include <cstddef>                       // std::size_t
+#include <cstdint>                       // std::uint64_t
+#include <memory>                        // 智能指针支持
+#include <utility>                       // std::move
+#include <vector>                        // std::vector 容器
+
+// 慢消费者的背压策略：发送队列超出上限时如何处理新消息
+enum class QueuePolicy {
+    drop_oldest,                                      // 丢弃最早的待发送消息，为新消息腾出空间
+    drop_newest,                                      // 丢弃新消息，保留已排队的消息
+    conflate,                                         // 丢弃全部待发送消息，只保留最新的一条
+    disconnect                                        // 断开连接
+};
+
+// 发送队列上限
+struct QueueLimits {
+    QueuePolicy policy = QueuePolicy::drop_oldest;    // 超限时的处理策略
+    std::size_t max_bytes = 4 * 1024 * 1024;          // 队列中帧字节总数上限
+    std::size_t max_messages = 1024;                  // 队列中消息条数上限
+    std::chrono::milliseconds max_lag{0};             // disconnect 策略下最早消息允许滞后的时长，0 表示不检查
+};
+
+// 一段连续 const_buffer 的非拥有视图，满足 ConstBufferSequence
+// 复制时不分配内存，适合交给 async_write 做聚集写
+class ConstBufferSpan {
+    boost::asio::const_buffer const* begin_;
+    boost::asio::const_buffer const* end_;
+
+public:
+    using value_type = boost::asio::const_buffer;
+    using const_iterator = boost::asio::const_buffer const*;
+
+    ConstBufferSpan(const_iterator begin, const_iterator end) noexcept
+        : begin_(begin), end_(end) {}
+
+    const_iterator begin() const noexcept {
+        return begin_;
+    }
+
+    const_iterator end() const noexcept {
+        return end_;
+    }
+};
+
+// 环形数组：发送队列的存储
+// 容量按 2 的幂增长并重复使用，稳定状态下入队、出队不分配内存（std::deque 每若干个元素就要分配、释放一个块）；
+// 队列清空且容量偏大时释放，避免突发之后长期占用内存
+template<class T>
+class Ring {
+    static constexpr std::size_t retained_capacity = 64;  // 清空后仍保留的容量上限
+
+    std::unique_ptr<T[]> slots_;                      // 存储，容量为 capacity_
+    std::size_t capacity_ = 0;                        // 容量，0 或 2 的幂
+    std::size_t head_ = 0;                            // 队首所在的槽位
+    std::size_t size_ = 0;                            // 元素个数
+
+public:
+    std::size_t size() const noexcept {
+        return size_;
+    }
+
+    bool empty() const noexcept {
+        return size_ == 0;
+    }
+
+    T& operator[](std::size_t i) noexcept {
+        return slots_[(head_ + i) & (capacity_ - 1)];
+    }
+
+    T const& operator[](std::size_t i) const noexcept {
+        return slots_[(head_ + i) & (capacity_ - 1)];
+    }
+
+    T& front() noexcept {
+        return (*this)[0];
+    }
+
+    T const& front() const noexcept {
+        return (*this)[0];
+    }
+
+    void push_back(T value) {
+        if(size_ == capacity_) {
+            grow();
+        }
+        (*this)[size_] = std::move(value);
+        ++size_;
+    }
+
+    void pop_front() {
+        front() = T();
+        head_ = (head_ + 1) & (capacity_ - 1);
+        --size_;
+        release_if_idle();
+    }
+
+    void pop_back() {
+        (*this)[size_ - 1] = T();
+        --size_;
+        release_if_idle();
+    }
+
+    // 删除下标为 index 的元素，移动较短的一侧
+    void erase(std::size_t index) {
+        if(index < size_ / 2) {
+            for(std::size_t i = index; i > 0; --i) {
+                (*this)[i] = std::move((*this)[i - 1]);
+            }
+            pop_front();
+        } else {
+            for(std::size_t i = index; i + 1 < size_; ++i) {
+                (*this)[i] = std::move((*this)[i + 1]);
+            }
+            pop_back();
+        }
+    }
+
+    void clear() {
+        for(std::size_t i = 0; i < size_; ++i) {
+            (*this)[i] = T();
+        }
+        size_ = 0;
+        head_ = 0;
+        release_if_idle();
+    }
+
+private:
+    void grow() {
+        auto const capacity = capacity_ ? capacity_ * 2 : 8;
+        std::unique_ptr<T[]> slots(new T[capacity]);
+        for(std::size_t i = 0; i < size_; ++i) {
+            slots[i] = std::move((*this)[i]);
+        }
+        slots_ = std::move(slots);
+        capacity_ = capacity;
+        head_ = 0;
+    }
+
+    void release_if_idle() {
+        if(size_ == 0 && capacity_ > retained_capacity) {
+            slots_.reset();
+            capacity_ = 0;
+            head_ = 0;
+        }
+    }
+};
+
+// 会话的有界发送队列
+//
+// 队首的若干条消息可能正在写入（in-flight），它们不会被丢弃；
+// 其余待发送消息在超出上限时按策略处理。只在会话所属的事件循环线程上使用。
+// 各策略的丢弃计数与队列深度记入当前线程的 metrics 指标。
+//
+// 写入时把当前全部待发送消息（受字节上限约束）合并为一次聚集写，
+// 突发流量下多条消息只需一次 writev 系统调用。
+class OutboundQueue {
+public:
+    using clock = std::chrono::steady_clock;
+    using Frame = FrameRef;
+    using Trace = std::shared_ptr<tracing::MessageTrace>;
+
+    // push 的结果
+    enum class Result {
+        queued,                                       // 已入队
+        dropped,                                      // 新消息被丢弃
+        overflow                                      // 超出上限且策略为断开，调用方应关闭连接
+    };
+
+private:
+    struct Item {
+        Frame frame;                                  // 编码好的共享帧
+        clock::time_point enqueued;                   // 入队时间，只在启用滞后检查或追踪时记录
+        Trace trace;                                  // 消息的追踪，未启用追踪时为空
+    };
+
+    Ring<Item> items_;                                // 全部消息，队首 in_flight_ 条正在写入
+    std::size_t bytes_ = 0;                           // 全部消息的帧字节总数
+    std::size_t in_flight_ = 0;                       // 正在写入的消息条数
+    std::uint64_t shed_ = 0;                          // 本队列因背压丢弃的消息数
+    std::vector<boost::asio::const_buffer> gather_;   // 当前聚集写的缓冲区列表，重复使用以免每次分配
+
+public:
+    OutboundQueue() = default;
+    OutboundQueue(OutboundQueue const&) = delete;
+    OutboundQueue& operator=(OutboundQueue const&) = delete;
+
+    // 销毁时仍在队列中的消息从深度指标中扣除
+    ~OutboundQueue() {
+        track(-static_cast<std::int64_t>(items_.size()), -static_cast<std::int64_t>(bytes_));
+    }
+
+    // 按 limits 入队一条帧，超限时按策略处理并记录背压指标
+    // trace 非空时记录入队时刻，写完时再记录写入耗时
+    Result push(Frame const& frame, QueueLimits const& limits, Trace const& trace = nullptr) {
+        auto const size = frame->size();
+        bool const check_lag = limits.max_lag.count() > 0;
+        auto const now = check_lag || trace ? clock::now() : clock::time_point();
+
+        bool const lagging = check_lag && limits.policy == QueuePolicy::disconnect &&
+            !items_.empty() && now - items_.front().enqueued > limits.max_lag;
+
+        if(!lagging && !over_limit(size, limits)) {
+            append(frame, now, trace);
+            return Result::queued;
+        }
+
+        switch(limits.policy) {
+        case QueuePolicy::drop_newest:
+            ++shed_;
+            metrics::add(metrics::Counter::dropped_newest);
+            metrics::add(metrics::Counter::dropped_bytes, size);
+            return Result::dropped;
+
+        case QueuePolicy::disconnect:
+            metrics::add(metrics::Counter::slow_disconnects);
+            return Result::overflow;
+
+        case QueuePolicy::drop_oldest:
+            // 从最早的待发送消息开始丢弃，直到新消息放得下或只剩正在写入的消息
+            while(items_.size() > in_flight_ && over_limit(size, limits)) {
+                metrics::add(metrics::Counter::dropped_bytes, drop_pending(in_flight_));
+                metrics::add(metrics::Counter::dropped_oldest);
+            }
+            break;
+
+        case QueuePolicy::conflate:
+            // 待发送消息全部被最新的一条取代
+            while(items_.size() > in_flight_) {
+                metrics::add(metrics::Counter::dropped_bytes, drop_pending(items_.size() - 1));
+                metrics::add(metrics::Counter::conflated);
+            }
+            break;
+        }
+
+        append(frame, now, trace);
+        return Result::queued;
+    }
+
+    // 是否有尚未开始写入的消息
+    bool has_pending() const noexcept {
+        return items_.size() > in_flight_;
+    }
+
+    // 是否有写操作正在进行
+    bool writing() const noexcept {
+        return in_flight_ > 0;
+    }
+
+    // 把待发送消息依次标记为正在写入，直到累计字节数将超过 max_bytes
+    // （至少包含一条），返回这些帧的缓冲区视图，视图在 complete_write 之前有效
+    ConstBufferSpan begin_write(std::size_t max_bytes) {
+        gather_.clear();
+        std::size_t bytes = 0;
+        while(in_flight_ < items_.size()) {
+            auto const& frame = *items_[in_flight_].frame;
+            if(!gather_.empty() && bytes + frame.size() > max_bytes) {
+                break;
+            }
+            gather_.emplace_back(frame.data(), frame.size());
+            bytes += frame.size();
+            ++in_flight_;
+        }
+        return ConstBufferSpan(gather_.data(), gather_.data() + gather_.size());
+    }
+
+    // 正在写入的消息全部写完，将它们移出队列，返回移出的消息条数
+    std::size_t complete_write() {
+        auto const written = in_flight_;
+        std::size_t size = 0;
+        clock::time_point now;
+        for(; in_flight_ > 0; --in_flight_) {
+            auto& item = items_.front();
+            size += item.frame->size();
+            if(item.trace) {
+                if(now == clock::time_point()) {
+                    now = clock::now();
+                }
+                item.trace->written(item.enqueued, now);
+            }
+            items_.pop_front();
+        }
+        bytes_ -= size;
+        track(-static_cast<std::int64_t>(written), -static_cast<std::int64_t>(size));
+        return written;
+    }
+
+    // 清空队列（连接出错或关闭时）
+    void clear() {
+        track(-static_cast<std::int64_t>(items_.size()), -static_cast<std::int64_t>(bytes_));
+        items_.clear();
+        bytes_ = 0;
+        in_flight_ = 0;
+    }
+
+    // 队列中的消息条数与帧字节数
+    std::size_t size() const noexcept {
+        return items_.size();
+    }
+
+    std::size_t bytes() const noexcept {
+        return bytes_;
+    }
+
+    // 本队列因背压丢弃的消息数
+    std::uint64_t shed() const noexcept {
+        return shed_;
+    }
+
+private:
+    bool over_limit(std::size_t incoming, QueueLimits const& limits) const noexcept {
+        return items_.size() + 1 > limits.max_messages || bytes_ + incoming > limits.max_bytes;
+    }
+
+    void append(Frame const& frame, clock::time_point now, Trace const& trace) {
+        if(trace) {
+            trace->enqueued(now);
+        }
+        bytes_ += frame->size();
+        items_.push_back(Item{frame, now, trace});
+        track(1, static_cast<std::int64_t>(frame->size()));
+        metrics::observe(metrics::Hist::queue_depth, items_.size());
+    }
+
+    // 丢弃下标为 index 的待发送消息，返回它的帧字节数
+    std::size_t drop_pending(std::size_t index) {
+        auto const size = items_[index].frame->size();
+        bytes_ -= size;
+        items_.erase(index);
+        ++shed_;
+        track(-1, -static_cast<std::int64_t>(size));
+        return size;
+    }
+
+    // 更新全部发送队列的深度指标
+    static void track(std::int64_t messages, std::int64_t bytes) {
+        metrics::adjust(metrics::Gauge::queued_messages, messages);
+        metrics::adjust(metrics::Gauge::queued_bytes, bytes);
+    }
+};
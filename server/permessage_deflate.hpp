@@ -0,0 +1,105 @@
+#pragma once
+
+#include "frame_buffer.hpp"              // 压缩后的共享帧
+
+#include <boost/beast/http/rfc7230.hpp>  // 解析 Sec-WebSocket-Extensions
+#include <boost/beast/websocket/option.hpp>  // websocket::permessage_deflate
+#include <boost/beast/websocket/rfc6455.hpp>  // websocket::response_type
+#include <boost/beast/zlib/deflate_stream.hpp>  // Beast 自带的 deflate 实现
+#include <cstddef>                       // std::size_t
+#include <string>                        // std::stoi
+#include <string_view>                   // std::string_view 支持
+
+// permessage-deflate（RFC 7692）的配置、协商结果解析与广播帧压缩
+//
+// 协商与读取方向的解压由 Beast 完成；服务端发出的数据帧都绕过 Beast 原样写出，
+// 因此压缩在这里完成：每条消息用事件循环（线程）自己的压缩器、从空的上下文开始压缩一次，
+// 得到的帧被所有协商了压缩且窗口足够大的接收者共享。
+//
+// 不引用之前消息的压缩数据对客户端总是合法的，与是否协商 server_no_context_takeover 无关；
+// 服务端仍然声明 server_no_context_takeover，让客户端不必为解压保留窗口。
+struct DeflateOptions {
+    bool enabled = false;                             // 是否接受客户端的 permessage-deflate 请求
+    int server_window_bits = 15;                      // 服务端压缩窗口位数（server_max_window_bits），9-15
+    int client_window_bits = 15;                      // 客户端压缩窗口位数上限（client_max_window_bits），9-15
+    int mem_level = 8;                                // 压缩器内存级别，1-9
+    int level = 6;                                    // 压缩级别，0-9
+    bool client_context_takeover = false;             // 允许客户端跨消息沿用压缩上下文（服务端需为每个连接保留解压窗口）
+    std::size_t min_size = 64;                        // 负载小于该字节数的消息不压缩
+};
+
+namespace deflate {
+
+// 转换为 Beast 的协商选项
+inline boost::beast::websocket::permessage_deflate beast_options(DeflateOptions const& options) {
+    boost::beast::websocket::permessage_deflate pmd;
+    pmd.server_enable = options.enabled;
+    pmd.server_max_window_bits = options.server_window_bits;
+    pmd.client_max_window_bits = options.client_window_bits;
+    pmd.server_no_context_takeover = true;
+    pmd.client_no_context_takeover = !options.client_context_takeover;
+    pmd.compLevel = options.level;
+    pmd.memLevel = options.mem_level;
+    return pmd;
+}
+
+// 从握手响应中读出协商结果：返回服务端可以使用的最大窗口位数，未协商压缩时返回 0
+inline int negotiated_window_bits(boost::beast::websocket::response_type const& res) {
+    namespace http = boost::beast::http;
+    for(auto const& ext : http::ext_list(res[http::field::sec_websocket_extensions])) {
+        if(!boost::beast::iequals(ext.first, "permessage-deflate")) {
+            continue;
+        }
+        for(auto const& param : ext.second) {
+            if(boost::beast::iequals(param.first, "server_max_window_bits")) {
+                return std::stoi(std::string(param.second));
+            }
+        }
+        return 15;
+    }
+    return 0;
+}
+
+// 把一条消息压缩成 RSV1=1 的服务端帧；压缩后不比原文短时返回空
+// 只在事件循环线程上调用，压缩器按线程复用
+inline FrameRef compress(frame::opcode op, std::string_view payload, DeflateOptions const& options) {
+    namespace zlib = boost::beast::zlib;
+
+    struct Compressor {
+        zlib::deflate_stream stream;
+        DeflateOptions options;
+        bool configured = false;
+    };
+    thread_local Compressor c;
+    if(!c.configured || c.options.level != options.level || c.options.server_window_bits != options.server_window_bits ||
+       c.options.mem_level != options.mem_level) {
+        c.stream.reset(options.level, options.server_window_bits, options.mem_level, zlib::Strategy::normal);
+        c.options = options;
+        c.configured = true;
+    } else {
+        // 每条消息从空的上下文开始，保留已申请的内部缓冲区
+        c.stream.reset();
+    }
+
+    // 同步刷新会在末尾多写一个空的存储块（最多 5 字节，末 4 字节为 00 00 ff ff）
+    auto out = FrameBuffer::create(c.stream.upper_bound(payload.size()) + 8);
+    auto const space = out->prepare();
+
+    zlib::z_params zs;
+    zs.next_in = payload.data();
+    zs.avail_in = payload.size();
+    zs.next_out = space.data();
+    zs.avail_out = space.size();
+    boost::beast::error_code ec;
+    c.stream.write(zs, zlib::Flush::sync, ec);
+    if(ec || zs.avail_in != 0 || zs.total_out < 4 || zs.total_out - 4 >= payload.size()) {
+        return nullptr;
+    }
+
+    // 按 RFC 7692 第 7.2.1 节去掉末尾的 00 00 ff ff
+    out->commit(zs.total_out - 4);
+    out->seal(op, true);
+    return out;
+}
+
+} // namespace deflate
@@ -0,0 +1,112 @@
+#pragma once
+
+#include "session_registry.hpp"          // 分片会话注册表
+
+#include <cstddef>                       // std::size_t
+#include <memory>                        // 智能指针支持
+#include <mutex>                         // 互斥量支持
+#include <shared_mutex>                  // 读写锁
+#include <string>                        // std::string 支持
+#include <unordered_map>                 // 房间名 → 房间
+
+// 房间（主题）：一组订阅者，消息只扇出给房间成员
+// 成员按事件循环分组登记，发布时与全局广播一样逐循环遍历快照；
+// 每组的分片数与全局注册表相同，默认房间（每个连接都会加入）登记、注销时复制的快照同样较小
+template<class T>
+class Room {
+    std::string name_;                                // 房间名
+    SessionRegistry<T> members_;                      // 房间成员
+
+public:
+    Room(std::string name, std::size_t groups, std::size_t shards_per_group)
+        : name_(std::move(name)), members_(groups, shards_per_group) {}
+
+    std::string const& name() const noexcept {
+        return name_;
+    }
+
+    SessionRegistry<T>& members() noexcept {
+        return members_;
+    }
+
+    SessionRegistry<T> const& members() const noexcept {
+        return members_;
+    }
+};
+
+// 房间索引：房间名 → 房间
+//
+// 发布路径不经过索引：会话加入房间后直接持有房间的 shared_ptr，
+// 发布只读取房间成员的快照，因此加入、离开房间不会阻塞发布。
+// 索引本身由读写锁保护，只在加入、离开时访问；成员登记在共享锁下进行，
+// 删除空房间需要独占锁，从而保证不会有会话加入一个已被移出索引的房间。
+template<class T>
+class RoomIndex {
+    std::size_t groups_;                              // 每个房间成员的分组数（事件循环数）
+    std::size_t shards_per_group_;                    // 每组的分片数
+    mutable std::shared_mutex mutex_;                 // 保护 rooms_
+    std::unordered_map<std::string, std::shared_ptr<Room<T>>> rooms_;  // 全部非空房间
+
+public:
+    explicit RoomIndex(std::size_t groups, std::size_t shards_per_group = 1)
+        : groups_(groups), shards_per_group_(shards_per_group) {}
+
+    RoomIndex(RoomIndex const&) = delete;
+    RoomIndex& operator=(RoomIndex const&) = delete;
+
+    // 把 member 加入名为 name 的房间（不存在时创建），登记到 group 分组，
+    // 使用调用方持有的 hook；返回房间
+    std::shared_ptr<Room<T>> join(std::string const& name,
+                                  std::shared_ptr<T> const& member,
+                                  RegistryHook& hook,
+                                  std::size_t group) {
+        {
+            // 常见情况：房间已存在，只需共享锁
+            std::shared_lock<std::shared_mutex> lock(mutex_);
+            auto it = rooms_.find(name);
+            if(it != rooms_.end()) {
+                it->second->members().insert(member, hook, group);
+                return it->second;
+            }
+        }
+
+        std::unique_lock<std::shared_mutex> lock(mutex_);
+        auto& room = rooms_[name];
+        if(!room) {
+            room = std::make_shared<Room<T>>(name, groups_, shards_per_group_);
+        }
+        room->members().insert(member, hook, group);
+        return room;
+    }
+
+    // 注销 hook 对应的成员；房间变空时从索引中移除
+    void leave(Room<T>& room, RegistryHook& hook) {
+        if(room.members().erase(hook) != 0) {
+            return;
+        }
+
+        // 持有独占锁再次确认仍为空，期间不会有新的加入
+        std::shared_ptr<Room<T>> removed;
+        {
+            std::unique_lock<std::shared_mutex> lock(mutex_);
+            auto it = rooms_.find(room.name());
+            if(it != rooms_.end() && it->second.get() == &room && room.members().empty()) {
+                removed = std::move(it->second);
+                rooms_.erase(it);
+            }
+        }
+    }
+
+    // 按名称查找房间，不存在时返回空指针
+    std::shared_ptr<Room<T>> find(std::string const& name) const {
+        std::shared_lock<std::shared_mutex> lock(mutex_);
+        auto it = rooms_.find(name);
+        return it != rooms_.end() ? it->second : nullptr;
+    }
+
+    // 当前非空房间数
+    std::size_t size() const {
+        std::shared_lock<std::shared_mutex> lock(mutex_);
+        return rooms_.size();
+    }
+};
@@ -0,0 +1,318 @@
+#pragma once
+
+#include "logger.hpp"                    // 日志级别
+#include "outbound_queue.hpp"            // 发送队列上限与背压策略
+#include "permessage_deflate.hpp"        // 压缩扩展参数
+
+#include <chrono>                        // 时长参数
+#include <cstddef>                       // std::size_t
+#include <cstdint>                       // std::uint32_t
+#include <stdexcept>                     // std::invalid_argument
+#include <string>                        // std::string 支持
+#include <thread>                        // std::thread::hardware_concurrency
+#include <vector>                        // CPU 列表
+
+// socket 读写与接受连接使用的 I/O 后端
+enum class IoBackend {
+    epoll,                                            // Asio 的 reactor（默认）
+    io_uring,                                         // 每个事件循环一个 io_uring，不可用时退回 epoll
+};
+
+// 服务器配置，通过 --名称=值 形式的命令行参数设置
+struct ServerConfig {
+    unsigned short port = 8080;                       // 监听端口
+    std::size_t threads = default_threads();          // 事件循环线程数，每个线程一个 io_context
+    bool reuse_port = false;                          // 每个事件循环各自绑定一个 SO_REUSEPORT 接受器
+    std::vector<int> cpus;                            // 第 i 个事件循环绑定到 cpus[i % cpus.size()]，为空表示不绑定
+    std::size_t accept_batch = 16;                    // 每次异步接受完成后最多连续接受的连接数
+    bool shared_nothing = false;                      // 无共享模式：每个核心独立接受连接、维护房间，核心之间只经通道通信
+    std::size_t core_ring_size = 4096;                // 无共享模式下每条核心间通道的容量（条）
+    IoBackend io_backend = IoBackend::epoll;          // socket 读写使用的 I/O 后端
+    unsigned uring_entries = 4096;                    // 每个 io_uring 提交队列的容量
+    QueueLimits queue;                                // 每个会话发送队列的上限与背压策略
+    std::size_t max_flush_bytes = 256 * 1024;         // 一次聚集写最多合并的帧字节数
+    std::size_t buffer_pool_bytes = 4 * 1024 * 1024;  // 每个事件循环缓冲池最多保留的空闲字节数
+    std::size_t session_prealloc = 1024;              // 启动时为会话预先申请的 slab 块数，分摊到各事件循环
+    DeflateOptions deflate;                           // permessage-deflate 压缩扩展
+    std::chrono::milliseconds timer_tick{500};        // 时间轮的 tick 长度，超时与 ping 的精度
+    std::chrono::seconds handshake_timeout{30};       // 从连接建立（或上一个 HTTP 应答）到完成握手的期限，0 表示不限
+    std::chrono::seconds idle_timeout{300};           // 握手后连续收不到任何数据的超时，0 表示不限
+    std::chrono::seconds ping_interval{150};          // 空闲达到该时长时发出保活 ping，0 表示不发
+    std::chrono::seconds stats_interval{10};          // 输出背压统计的间隔，0 表示不输出
+    logging::Level log_level = logging::Level::info;  // 日志级别阈值
+    std::uint32_t log_sample = 1;                     // 逐消息日志每 N 条记录 1 条
+    bool trace = false;                               // 追踪每条消息各阶段的延迟
+    std::chrono::microseconds trace_threshold{10000}; // 端到端耗时超过该值的消息输出追踪
+
+    // 默认每个 CPU 核心一个事件循环
+    static std::size_t default_threads() {
+        auto const cores = std::thread::hardware_concurrency();
+        return cores > 0 ? cores : 1;
+    }
+};
+
+// 命令行用法说明
+inline char const* server_usage() {
+    return
+        "用法: websocket_server [选项]\n"
+        "  --port=N        监听端口（默认 8080）\n"
+        "  --threads=N     事件循环线程数（默认 CPU 核数）\n"
+        "  --reuseport=0|1 每个事件循环各自监听端口，由内核分配新连接（默认 0）\n"
+        "  --cpus=LIST     把事件循环线程依次绑定到这些 CPU，如 0-3,8-11；未指定 --threads 时线程数取 CPU 个数\n"
+        "  --accept-batch=N 每次唤醒最多连续接受的连接数（默认 16）\n"
+        "  --shared-nothing=0|1 每个核心独立接受连接并维护房间，核心之间只经有界通道转发消息，隐含 --reuseport=1（默认 0）\n"
+        "  --core-ring-size=N 无共享模式下每条核心间通道的容量（默认 4096）\n"
+        "  --io-backend=B  socket 读写的 I/O 后端: epoll | io_uring，io_uring 不可用时退回 epoll（默认 epoll）\n"
+        "  --uring-entries=N 每个事件循环 io_uring 提交队列的容量，1-32768（默认 4096）\n"
+        "  --queue-policy=P 发送队列超限策略: drop-oldest | drop-newest | conflate | disconnect（默认 drop-oldest）\n"
+        "  --max-queue-bytes=N    每个会话发送队列的字节上限（默认 4194304）\n"
+        "  --max-queue-messages=N 每个会话发送队列的消息条数上限（默认 1024）\n"
+        "  --max-flush-bytes=N    一次聚集写最多合并的帧字节数（默认 262144）\n"
+        "  --buffer-pool-bytes=N  每个事件循环缓冲池最多保留的空闲字节数（默认 4194304）\n"
+        "  --session-prealloc=N   启动时预先申请的会话内存块数（默认 1024）\n"
+        "  --deflate=0|1   接受客户端的 permessage-deflate 压缩请求（默认 0）\n"
+        "  --deflate-window-bits=N 服务端压缩窗口位数 9-15（默认 15）\n"
+        "  --deflate-client-window-bits=N 客户端压缩窗口位数上限 9-15（默认 15）\n"
+        "  --deflate-mem-level=N  压缩器内存级别 1-9（默认 8）\n"
+        "  --deflate-level=N      压缩级别 0-9（默认 6）\n"
+        "  --deflate-context-takeover=0|1 允许客户端跨消息沿用压缩上下文（默认 0）\n"
+        "  --deflate-min-size=N   负载小于 N 字节的消息不压缩（默认 64）\n"
+        "  --timer-tick-ms=N      超时时间轮的 tick 毫秒数（默认 500）\n"
+        "  --handshake-timeout=N  完成握手的秒数期限，0 表示不限（默认 30）\n"
+        "  --idle-timeout=N       连续 N 秒收不到数据即断开，0 表示不限（默认 300）\n"
+        "  --ping-interval=N      空闲 N 秒时发出保活 ping，0 表示不发（默认 150）\n"
+        "  --max-lag-ms=N  disconnect 策略下最早消息允许滞后的毫秒数，0 表示不检查（默认 0）\n"
+        "  --stats-interval=N 输出背压统计的秒数间隔，0 表示不输出（默认 10）\n"
+        "  --log-level=L   日志级别: debug | info | warn | error | off（默认 info）\n"
+        "  --log-sample=N  逐消息日志每 N 条记录 1 条（默认 1）\n"
+        "  --trace=0|1     追踪每条消息从读取到写完各阶段的延迟（默认 0）\n"
+        "  --trace-threshold-us=N 端到端耗时超过 N 微秒的消息输出追踪（默认 10000）\n";
+}
+
+namespace detail {
+
+// 解析非负整数参数，失败时抛出 std::invalid_argument
+inline unsigned long parse_number(std::string const& name, std::string const& value) {
+    std::size_t end = 0;
+    unsigned long result = 0;
+    try {
+        result = std::stoul(value, &end);
+    } catch(std::exception const&) {
+        end = 0;
+    }
+    if(value.empty() || end != value.size()) {
+        throw std::invalid_argument("参数 --" + name + " 需要一个非负整数: " + value);
+    }
+    return result;
+}
+
+// 解析取值在 [low, high] 之间的整数参数，失败时抛出 std::invalid_argument
+inline int parse_range(std::string const& name, std::string const& value, int low, int high) {
+    auto const result = parse_number(name, value);
+    if(result < static_cast<unsigned long>(low) || result > static_cast<unsigned long>(high)) {
+        throw std::invalid_argument("参数 --" + name + " 需要 " + std::to_string(low) + "-" +
+                                    std::to_string(high) + " 之间的整数: " + value);
+    }
+    return static_cast<int>(result);
+}
+
+// 解析 0/1 开关参数，失败时抛出 std::invalid_argument
+inline bool parse_flag(std::string const& name, std::string const& value) {
+    if(value == "1" || value == "true") {
+        return true;
+    }
+    if(value == "0" || value == "false") {
+        return false;
+    }
+    throw std::invalid_argument("参数 --" + name + " 需要 0 或 1: " + value);
+}
+
+// 解析 CPU 列表（如 0-3,8,10-11），失败时抛出 std::invalid_argument
+inline std::vector<int> parse_cpu_list(std::string const& name, std::string const& value) {
+    constexpr unsigned long max_cpu = 1023;
+    std::vector<int> cpus;
+    std::size_t begin = 0;
+    while(begin <= value.size()) {
+        auto end = value.find(',', begin);
+        if(end == std::string::npos) {
+            end = value.size();
+        }
+        auto const item = value.substr(begin, end - begin);
+        auto const dash = item.find('-');
+        auto const first = parse_number(name, item.substr(0, dash));
+        auto const last = dash == std::string::npos ? first : parse_number(name, item.substr(dash + 1));
+        if(last < first || last > max_cpu) {
+            throw std::invalid_argument("参数 --" + name + " 的 CPU 范围无效: " + item);
+        }
+        for(auto cpu = first; cpu <= last; ++cpu) {
+            cpus.push_back(static_cast<int>(cpu));
+        }
+        begin = end + 1;
+    }
+    return cpus;
+}
+
+// 解析背压策略名称，失败时抛出 std::invalid_argument
+inline QueuePolicy parse_policy(std::string const& value) {
+    if(value == "drop-oldest") {
+        return QueuePolicy::drop_oldest;
+    }
+    if(value == "drop-newest") {
+        return QueuePolicy::drop_newest;
+    }
+    if(value == "conflate") {
+        return QueuePolicy::conflate;
+    }
+    if(value == "disconnect") {
+        return QueuePolicy::disconnect;
+    }
+    throw std::invalid_argument("未知的背压策略: " + value);
+}
+
+// 解析 I/O 后端名称，失败时抛出 std::invalid_argument
+inline IoBackend parse_backend(std::string const& value) {
+    if(value == "epoll") {
+        return IoBackend::epoll;
+    }
+    if(value == "io_uring" || value == "io-uring" || value == "uring") {
+        return IoBackend::io_uring;
+    }
+    throw std::invalid_argument("未知的 I/O 后端: " + value);
+}
+
+// 解析日志级别名称，失败时抛出 std::invalid_argument
+inline logging::Level parse_level(std::string const& value) {
+    if(value == "debug") {
+        return logging::Level::debug;
+    }
+    if(value == "info") {
+        return logging::Level::info;
+    }
+    if(value == "warn") {
+        return logging::Level::warn;
+    }
+    if(value == "error") {
+        return logging::Level::error;
+    }
+    if(value == "off") {
+        return logging::Level::off;
+    }
+    throw std::invalid_argument("未知的日志级别: " + value);
+}
+
+} // namespace detail
+
+// 解析命令行参数，遇到未知参数或非法取值时抛出 std::invalid_argument
+inline ServerConfig parse_config(int argc, char** argv) {
+    ServerConfig config;
+    bool threads_given = false;
+    for(int i = 1; i < argc; ++i) {
+        std::string const arg = argv[i];
+        auto const eq = arg.find('=');
+        if(arg.compare(0, 2, "--") != 0 || eq == std::string::npos) {
+            throw std::invalid_argument("无法识别的参数: " + arg);
+        }
+        auto const name = arg.substr(2, eq - 2);
+        auto const value = arg.substr(eq + 1);
+
+        if(name == "port") {
+            auto const port = detail::parse_number(name, value);
+            if(port == 0 || port > 65535) {
+                throw std::invalid_argument("端口超出范围: " + value);
+            }
+            config.port = static_cast<unsigned short>(port);
+        } else if(name == "threads") {
+            config.threads = detail::parse_number(name, value);
+            if(config.threads == 0) {
+                config.threads = ServerConfig::default_threads();
+            }
+            threads_given = true;
+        } else if(name == "reuseport") {
+            config.reuse_port = detail::parse_flag(name, value);
+        } else if(name == "cpus") {
+            config.cpus = detail::parse_cpu_list(name, value);
+        } else if(name == "accept-batch") {
+            config.accept_batch = detail::parse_number(name, value);
+            if(config.accept_batch == 0) {
+                throw std::invalid_argument("参数 --accept-batch 至少为 1");
+            }
+        } else if(name == "shared-nothing") {
+            config.shared_nothing = detail::parse_flag(name, value);
+        } else if(name == "core-ring-size") {
+            config.core_ring_size = detail::parse_number(name, value);
+            if(config.core_ring_size == 0) {
+                throw std::invalid_argument("参数 --core-ring-size 至少为 1");
+            }
+        } else if(name == "io-backend") {
+            config.io_backend = detail::parse_backend(value);
+        } else if(name == "uring-entries") {
+            config.uring_entries = static_cast<unsigned>(detail::parse_range(name, value, 1, 32768));
+        } else if(name == "queue-policy") {
+            config.queue.policy = detail::parse_policy(value);
+        } else if(name == "max-queue-bytes") {
+            config.queue.max_bytes = detail::parse_number(name, value);
+        } else if(name == "max-queue-messages") {
+            config.queue.max_messages = detail::parse_number(name, value);
+            if(config.queue.max_messages == 0) {
+                throw std::invalid_argument("参数 --max-queue-messages 至少为 1");
+            }
+        } else if(name == "max-flush-bytes") {
+            config.max_flush_bytes = detail::parse_number(name, value);
+        } else if(name == "buffer-pool-bytes") {
+            config.buffer_pool_bytes = detail::parse_number(name, value);
+        } else if(name == "session-prealloc") {
+            config.session_prealloc = detail::parse_number(name, value);
+        } else if(name == "deflate") {
+            config.deflate.enabled = detail::parse_flag(name, value);
+        } else if(name == "deflate-window-bits") {
+            config.deflate.server_window_bits = detail::parse_range(name, value, 9, 15);
+        } else if(name == "deflate-client-window-bits") {
+            config.deflate.client_window_bits = detail::parse_range(name, value, 9, 15);
+        } else if(name == "deflate-mem-level") {
+            config.deflate.mem_level = detail::parse_range(name, value, 1, 9);
+        } else if(name == "deflate-level") {
+            config.deflate.level = detail::parse_range(name, value, 0, 9);
+        } else if(name == "deflate-context-takeover") {
+            config.deflate.client_context_takeover = detail::parse_flag(name, value);
+        } else if(name == "deflate-min-size") {
+            config.deflate.min_size = detail::parse_number(name, value);
+        } else if(name == "timer-tick-ms") {
+            config.timer_tick = std::chrono::milliseconds(detail::parse_number(name, value));
+            if(config.timer_tick.count() == 0) {
+                throw std::invalid_argument("参数 --timer-tick-ms 至少为 1");
+            }
+        } else if(name == "handshake-timeout") {
+            config.handshake_timeout = std::chrono::seconds(detail::parse_number(name, value));
+        } else if(name == "idle-timeout") {
+            config.idle_timeout = std::chrono::seconds(detail::parse_number(name, value));
+        } else if(name == "ping-interval") {
+            config.ping_interval = std::chrono::seconds(detail::parse_number(name, value));
+        } else if(name == "max-lag-ms") {
+            config.queue.max_lag = std::chrono::milliseconds(detail::parse_number(name, value));
+        } else if(name == "stats-interval") {
+            config.stats_interval = std::chrono::seconds(detail::parse_number(name, value));
+        } else if(name == "log-level") {
+            config.log_level = detail::parse_level(value);
+        } else if(name == "log-sample") {
+            config.log_sample = static_cast<std::uint32_t>(detail::parse_number(name, value));
+            if(config.log_sample == 0) {
+                throw std::invalid_argument("参数 --log-sample 至少为 1");
+            }
+        } else if(name == "trace") {
+            config.trace = detail::parse_flag(name, value);
+        } else if(name == "trace-threshold-us") {
+            config.trace_threshold = std::chrono::microseconds(detail::parse_number(name, value));
+        } else {
+            throw std::invalid_argument("无法识别的参数: " + arg);
+        }
+    }
+    // 绑定 CPU 时默认每个 CPU 一个事件循环
+    if(!config.cpus.empty() && !threads_given) {
+        config.threads = config.cpus.size();
+    }
+    // 无共享模式下每个核心都有自己的接受器
+    if(config.shared_nothing) {
+        config.reuse_port = true;
+    }
+    return config;
+}
@@ -0,0 +1,200 @@
+#pragma once
+
+#include <atomic>                        // 原子计数
+#include <cstddef>                       // std::size_t
+#include <cstdint>                       // std::uintptr_t
+#include <limits>                        // std::numeric_limits
+#include <memory>                        // 智能指针支持
+#include <mutex>                         // 互斥量支持
+#include <vector>                        // std::vector 容器
+
+// 注册表挂钩：记录一次登记所在的分片与槽位，使删除操作无需查找即可 O(1) 完成
+// 同一个对象登记到多个注册表（例如多个房间）时，每次登记使用各自的挂钩
+struct RegistryHook {
+    static constexpr std::size_t npos = std::numeric_limits<std::size_t>::max();
+
+    std::size_t shard = npos;                         // 所在分片，npos 表示未登记
+    std::size_t slot = 0;                             // 分片内的槽位下标
+};
+
+// 分片的会话注册表，替代全局 std::set + 单个互斥量
+//
+// - 分片按组划分（例如每个事件循环一组），可以只遍历某一组的会话
+// - 每个分片有独立的互斥量，只在连接、断开时由写者持有
+// - 分片内的会话连续存放在 std::vector 中，删除时与末尾元素交换，遍历对缓存友好
+// - 每个分片对外发布一份不可变快照（写时复制）：登记或注销时复制出新数组、
+//   修改后原子地替换旧快照；广播只原子地取得快照引用，遍历期间不持有任何锁，
+//   旧快照在最后一个读者放下引用后自动回收
+// - 挂钩由调用方持有，登记期间地址必须保持不变；
+//   不显式传入挂钩时使用 T 的 RegistryHook& registry_hook() 成员函数
+template<class T>
+class SessionRegistry {
+public:
+    // 槽位：会话本身以及这次登记使用的挂钩
+    struct Entry {
+        std::shared_ptr<T> item;
+        RegistryHook* hook;
+    };
+
+    using Slots = std::vector<Entry>;
+    using Snapshot = std::shared_ptr<Slots const>;
+
+private:
+    // 每个分片独占缓存行，避免相邻分片之间产生伪共享
+    struct alignas(64) Shard {
+        std::mutex mutex;                             // 串行化本分片的写者
+        Snapshot snapshot;                            // 当前发布的快照，为空表示没有会话；只通过 std::atomic_load/store 访问
+        std::atomic<std::size_t> count{0};            // 快照中的会话数，判断分组是否为空时无需取快照
+    };
+
+    std::size_t group_count_;                         // 分组数量
+    std::size_t shards_per_group_;                    // 每组的分片数量
+    std::size_t shard_count_;                         // 分片总数
+    std::unique_ptr<Shard[]> shards_;                 // 全部分片，同一组的分片相邻存放
+    std::atomic<std::size_t> size_{0};                // 全部分片的会话总数
+
+public:
+    // 构造函数：共 groups 组、每组 shards_per_group 个分片，均至少为 1
+    explicit SessionRegistry(std::size_t groups, std::size_t shards_per_group = 1)
+        : group_count_(groups > 0 ? groups : 1),
+          shards_per_group_(shards_per_group > 0 ? shards_per_group : 1),
+          shard_count_(group_count_ * shards_per_group_),
+          shards_(new Shard[shard_count_]) {}
+
+    SessionRegistry(SessionRegistry const&) = delete;
+    SessionRegistry& operator=(SessionRegistry const&) = delete;
+
+    // 登记一个会话，按地址散列到任意分片，返回登记后的会话总数
+    std::size_t insert(std::shared_ptr<T> const& item) {
+        return insert_into(item, item->registry_hook(), shard_of(item.get(), shard_count_));
+    }
+
+    // 登记一个会话到指定分组，返回登记后的会话总数
+    std::size_t insert(std::shared_ptr<T> const& item, std::size_t group) {
+        return insert(item, item->registry_hook(), group);
+    }
+
+    // 使用调用方提供的挂钩登记一个会话到指定分组，返回登记后的会话总数
+    std::size_t insert(std::shared_ptr<T> const& item, RegistryHook& hook, std::size_t group) {
+        return insert_into(item, hook,
+            group * shards_per_group_ + shard_of(item.get(), shards_per_group_));
+    }
+
+    // 注销一个会话，返回注销后的会话总数；未登记的会话会被忽略
+    std::size_t erase(T& item) {
+        return erase(item.registry_hook());
+    }
+
+    // 注销挂钩对应的那次登记，返回注销后的会话总数；未登记的挂钩会被忽略
+    std::size_t erase(RegistryHook& hook) {
+        if(hook.shard == RegistryHook::npos) {
+            return size();
+        }
+
+        // 旧快照移到锁外释放，避免在持锁时析构会话
+        Snapshot previous;
+        {
+            auto& shard = shards_[hook.shard];
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            previous = std::atomic_load(&shard.snapshot);
+
+            // 与末尾元素交换后弹出，并更新被移动元素的槽位；分片变空时不再保留数组
+            Snapshot next;
+            if(previous->size() > 1) {
+                auto slots = std::make_shared<Slots>(*previous);
+                if(hook.slot != slots->size() - 1) {
+                    (*slots)[hook.slot] = std::move(slots->back());
+                    (*slots)[hook.slot].hook->slot = hook.slot;
+                }
+                slots->pop_back();
+                next = std::move(slots);
+            }
+            hook.shard = RegistryHook::npos;
+            std::atomic_store(&shard.snapshot, std::move(next));
+            shard.count.fetch_sub(1, std::memory_order_relaxed);
+        }
+        return size_.fetch_sub(1, std::memory_order_relaxed) - 1;
+    }
+
+    // 取得某个分片当前的快照，快照中的会话在引用释放前一直有效；可能为空
+    Snapshot snapshot(std::size_t shard) const {
+        return std::atomic_load(&shards_[shard].snapshot);
+    }
+
+    // 依次对每个会话调用 fn，逐个分片取快照遍历，不持有任何锁
+    // 遍历期间发生的登记、注销不影响本次遍历看到的会话集合
+    template<class Function>
+    void for_each(Function&& fn) const {
+        for_each_shard(0, shard_count_, fn);
+    }
+
+    // 只遍历某一组的会话
+    template<class Function>
+    void for_each(std::size_t group, Function&& fn) const {
+        auto const first = group * shards_per_group_;
+        for_each_shard(first, first + shards_per_group_, fn);
+    }
+
+    // 当前登记的会话总数
+    std::size_t size() const noexcept {
+        return size_.load(std::memory_order_relaxed);
+    }
+
+    bool empty() const noexcept {
+        return size() == 0;
+    }
+
+    // 某一组当前是否没有会话；只读各分片的计数，不取快照
+    bool empty(std::size_t group) const noexcept {
+        auto const first = group * shards_per_group_;
+        for(std::size_t i = first; i < first + shards_per_group_; ++i) {
+            if(shards_[i].count.load(std::memory_order_relaxed) != 0) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    std::size_t shard_count() const noexcept {
+        return shard_count_;
+    }
+
+    std::size_t group_count() const noexcept {
+        return group_count_;
+    }
+
+private:
+    std::size_t insert_into(std::shared_ptr<T> const& item, RegistryHook& hook, std::size_t index) {
+        auto& shard = shards_[index];
+        {
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            auto const previous = std::atomic_load(&shard.snapshot);
+            auto next = previous ? std::make_shared<Slots>(*previous) : std::make_shared<Slots>();
+            hook.shard = index;
+            hook.slot = next->size();
+            next->push_back(Entry{item, &hook});
+            std::atomic_store(&shard.snapshot, Snapshot(std::move(next)));
+            shard.count.fetch_add(1, std::memory_order_relaxed);
+        }
+        return size_.fetch_add(1, std::memory_order_relaxed) + 1;
+    }
+
+    template<class Function>
+    void for_each_shard(std::size_t first, std::size_t last, Function& fn) const {
+        for(std::size_t i = first; i < last; ++i) {
+            auto const slots = snapshot(i);
+            if(!slots) {
+                continue;
+            }
+            for(auto const& entry : *slots) {
+                fn(entry.item);
+            }
+        }
+    }
+
+    // 按对象地址散列到 [0, n)；去掉低位的对齐位以便分布均匀
+    static std::size_t shard_of(T const* item, std::size_t n) noexcept {
+        auto const key = reinterpret_cast<std::uintptr_t>(item) >> 6;
+        return static_cast<std::size_t>(key % n);
+    }
+};
@@ -0,0 +1,216 @@
+#pragma once
+
+#include <atomic>                        // 超出块大小的请求计数
+#include <cstddef>                       // std::size_t
+#include <memory>                        // std::allocate_shared
+#include <mutex>                         // 互斥量支持
+#include <new>                           // 对齐的 operator new / delete
+#include <vector>                        // std::vector 容器
+
+// 定长内存块的 slab：按块批量申请连续内存，释放的块留在空闲链表中重复使用
+//
+// 用于会话对象（连同 shared_ptr 的控制块）：同一事件循环的会话紧凑地排在少数几段连续内存里，
+// 广播遍历时缓存与 TLB 的命中率更高；断开的会话留下的块由下一个新连接复用，
+// 连接风暴时不必逐个向堆申请。内存只增不减，保留在历史最高水位。
+//
+// 会话在接受连接的线程上创建，而最后一个引用可能在任何事件循环上释放，因此申请与归还都加锁；
+// 两者都只发生在连接建立与断开时，锁几乎没有竞争。
+class Slab {
+    static constexpr std::size_t alignment = 64;      // 块按缓存行对齐，相邻会话不共享缓存行
+
+    struct FreeBlock {
+        FreeBlock* next;
+    };
+
+    std::size_t const block_size_;                    // 块大小，alignment 的整数倍
+    std::size_t const chunk_blocks_;                  // 每次批量申请的块数
+    std::mutex mutex_;                                // 保护以下成员
+    FreeBlock* free_ = nullptr;                       // 空闲链表
+    std::vector<void*> chunks_;                       // 已申请的连续内存段
+    std::size_t capacity_ = 0;                        // 全部块数
+    std::size_t in_use_ = 0;                          // 正在使用的块数
+    std::atomic<std::size_t> oversized_{0};           // 超过块大小、退回堆分配的请求数
+
+public:
+    // block_size 为单个对象所需的最大字节数
+    explicit Slab(std::size_t block_size, std::size_t chunk_blocks = 64)
+        : block_size_((block_size + alignment - 1) / alignment * alignment),
+          chunk_blocks_(chunk_blocks ? chunk_blocks : 1) {}
+
+    Slab(Slab const&) = delete;
+    Slab& operator=(Slab const&) = delete;
+
+    // 所有块都必须已经归还
+    ~Slab() {
+        for(void* chunk : chunks_) {
+            ::operator delete(chunk, std::align_val_t(alignment));
+        }
+    }
+
+    // 预热：批量申请内存直到至少有 count 个块，并写入空闲链表（同时触碰每一页）
+    void reserve(std::size_t count) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        while(capacity_ < count) {
+            grow();
+        }
+    }
+
+    // 申请 bytes 字节；超过块大小的请求说明块大小定得不对，计数后退回同样对齐的堆分配
+    void* allocate(std::size_t bytes) {
+        if(bytes > block_size_) {
+            oversized_.fetch_add(1, std::memory_order_relaxed);
+            return ::operator new(bytes, std::align_val_t(alignment));
+        }
+        std::lock_guard<std::mutex> lock(mutex_);
+        if(!free_) {
+            grow();
+        }
+        auto* block = free_;
+        free_ = block->next;
+        ++in_use_;
+        return block;
+    }
+
+    void deallocate(void* pointer, std::size_t bytes) noexcept {
+        if(bytes > block_size_) {
+            ::operator delete(pointer, std::align_val_t(alignment));
+            return;
+        }
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto* block = static_cast<FreeBlock*>(pointer);
+        block->next = free_;
+        free_ = block;
+        --in_use_;
+    }
+
+    std::size_t block_size() const noexcept {
+        return block_size_;
+    }
+
+    // 退回堆分配的请求数，非零表示块大小小于实际对象
+    std::size_t oversized() const noexcept {
+        return oversized_.load(std::memory_order_relaxed);
+    }
+
+    std::size_t capacity() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return capacity_;
+    }
+
+    std::size_t in_use() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return in_use_;
+    }
+
+private:
+    // 申请一段新的连续内存，按地址倒序压入空闲链表，使之后按地址顺序取出
+    void grow() {
+        chunks_.reserve(chunks_.size() + 1);
+        auto* chunk = static_cast<unsigned char*>(
+            ::operator new(block_size_ * chunk_blocks_, std::align_val_t(alignment)));
+        chunks_.push_back(chunk);
+        for(std::size_t i = chunk_blocks_; i-- > 0;) {
+            auto* block = reinterpret_cast<FreeBlock*>(chunk + i * block_size_);
+            block->next = free_;
+            free_ = block;
+        }
+        capacity_ += chunk_blocks_;
+    }
+};
+
+// 从 Slab 分配单个对象的标准分配器，配合 std::allocate_shared 使用
+// 控制块与对象共用一个块；数组等多元素请求直接使用堆
+template<class T>
+class SlabAllocator {
+    template<class> friend class SlabAllocator;
+
+    Slab* slab_;
+
+public:
+    using value_type = T;
+
+    explicit SlabAllocator(Slab& slab) noexcept
+        : slab_(&slab) {}
+
+    template<class U>
+    SlabAllocator(SlabAllocator<U> const& other) noexcept
+        : slab_(other.slab_) {}
+
+    T* allocate(std::size_t n) {
+        if(n != 1) {
+            return static_cast<T*>(::operator new(sizeof(T) * n));
+        }
+        return static_cast<T*>(slab_->allocate(sizeof(T)));
+    }
+
+    void deallocate(T* pointer, std::size_t n) noexcept {
+        if(n != 1) {
+            ::operator delete(pointer);
+            return;
+        }
+        slab_->deallocate(pointer, sizeof(T));
+    }
+
+    template<class U>
+    bool operator==(SlabAllocator<U> const& other) const noexcept {
+        return slab_ == other.slab_;
+    }
+
+    template<class U>
+    bool operator!=(SlabAllocator<U> const& other) const noexcept {
+        return slab_ != other.slab_;
+    }
+};
+
+// 只记录请求大小的分配器：allocate_shared 把它重绑定到实际的控制块类型后申请一次，
+// 由此测得对象与控制块合在一起的真实大小，不必猜测标准库控制块的布局
+template<class T>
+class SizeProbe {
+    template<class> friend class SizeProbe;
+
+    std::size_t* largest_;                            // 见过的最大请求字节数
+
+public:
+    using value_type = T;
+
+    explicit SizeProbe(std::size_t& largest) noexcept
+        : largest_(&largest) {}
+
+    template<class U>
+    SizeProbe(SizeProbe<U> const& other) noexcept
+        : largest_(other.largest_) {}
+
+    T* allocate(std::size_t n) {
+        if(sizeof(T) * n > *largest_) {
+            *largest_ = sizeof(T) * n;
+        }
+        return static_cast<T*>(::operator new(sizeof(T) * n));
+    }
+
+    void deallocate(T* pointer, std::size_t) noexcept {
+        ::operator delete(pointer);
+    }
+
+    template<class U>
+    bool operator==(SizeProbe<U> const& other) const noexcept {
+        return largest_ == other.largest_;
+    }
+
+    template<class U>
+    bool operator!=(SizeProbe<U> const& other) const noexcept {
+        return largest_ != other.largest_;
+    }
+};
+
+// std::allocate_shared<T>(SlabAllocator<T>, ...) 向 slab 申请的块大小
+// 用大小、对齐与 T 相同的替身测量，不需要构造 T；SizeProbe 与 SlabAllocator 都只保存一个指针，
+// 两者重绑定出的控制块布局相同
+template<class T>
+std::size_t shared_block_size() {
+    struct alignas(T) Stand {
+        unsigned char bytes[sizeof(T)];
+    };
+    std::size_t largest = 0;
+    std::allocate_shared<Stand>(SizeProbe<Stand>(largest));
+    return largest;
+}
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <atomic>                        // 读写下标
+#include <cstddef>                       // std::size_t
+#include <memory>                        // std::unique_ptr
+#include <optional>                      // 槽位中的元素
+#include <utility>                       // std::move
+
+// 有界的单生产者 / 单消费者环形队列
+//
+// 一个线程只调用 push，另一个线程只调用 pop；两端各自拥有一个下标，并缓存对方下标的最近取值，
+// 只有在缓存显示已满（或已空）时才去读对方的缓存行，稳定状态下两端不争抢同一缓存行。
+// 容量向上取整为 2 的幂；已满时 push 返回 false，由调用方决定丢弃还是另行处理。
+template<class T>
+class SpscRing {
+    static constexpr std::size_t cache_line = 64;
+
+    std::size_t const mask_;                          // 容量 - 1
+    std::unique_ptr<std::optional<T>[]> slots_;       // 元素存储
+
+    // 生产者一侧：写下标与对读下标的缓存
+    alignas(cache_line) std::atomic<std::size_t> tail_{0};
+    std::size_t cached_head_ = 0;
+
+    // 消费者一侧：读下标与对写下标的缓存
+    alignas(cache_line) std::atomic<std::size_t> head_{0};
+    std::size_t cached_tail_ = 0;
+
+    static std::size_t round_up(std::size_t n) noexcept {
+        std::size_t capacity = 2;
+        while(capacity < n) {
+            capacity <<= 1;
+        }
+        return capacity;
+    }
+
+public:
+    explicit SpscRing(std::size_t capacity)
+        : mask_(round_up(capacity) - 1),
+          slots_(new std::optional<T>[mask_ + 1]) {}
+
+    SpscRing(SpscRing const&) = delete;
+    SpscRing& operator=(SpscRing const&) = delete;
+
+    std::size_t capacity() const noexcept {
+        return mask_ + 1;
+    }
+
+    // 生产者调用：放入一个元素，已满时返回 false 且不移动 value
+    bool push(T&& value) {
+        auto const tail = tail_.load(std::memory_order_relaxed);
+        if(tail - cached_head_ > mask_) {
+            cached_head_ = head_.load(std::memory_order_acquire);
+            if(tail - cached_head_ > mask_) {
+                return false;
+            }
+        }
+        slots_[tail & mask_].emplace(std::move(value));
+        tail_.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    // 消费者调用：取出一个元素，为空时返回 false
+    bool pop(T& out) {
+        auto const head = head_.load(std::memory_order_relaxed);
+        if(head == cached_tail_) {
+            cached_tail_ = tail_.load(std::memory_order_acquire);
+            if(head == cached_tail_) {
+                return false;
+            }
+        }
+        auto& slot = slots_[head & mask_];
+        out = std::move(*slot);
+        slot.reset();
+        head_.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    // 消费者调用：是否为空（读取生产者的下标）
+    bool empty() const noexcept {
+        return head_.load(std::memory_order_relaxed) == tail_.load(std::memory_order_acquire);
+    }
+};
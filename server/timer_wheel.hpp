@@ -0,0 +1,178 @@
+#pragma once
+
+#include <array>                         // 各层的槽位
+#include <chrono>                        // tick 长度
+#include <cstddef>                       // std::size_t
+#include <cstdint>                       // std::uint64_t
+
+// 分层时间轮：一个事件循环上全部会话的握手期限、空闲超时与保活 ping 共用一个定时器
+//
+// 时间以 tick 为单位，由事件循环上的一个 steady_timer 每个 tick 推进一次。
+// 共 levels 层、每层 slots 个槽位：第 0 层每个槽位对应 1 个 tick，第 l 层每个槽位对应 slots^l 个 tick；
+// 定时器按距到期的 tick 数放入能容纳它的最低一层，上层槽位在下层转完一圈时整体下放（级联）。
+// 登记、取消都是 O(1) 的链表操作，推进一个 tick 只处理一个槽位，与定时器总数无关。
+//
+// 挂钩（Hook）由拥有者持有，登记期间地址必须保持不变；到期时调用 T 的 void on_timer()，
+// 此时挂钩已经摘下，拥有者可以在回调中重新登记。只能在时间轮所属事件循环的线程上使用，不加锁。
+template<class T>
+class TimerWheel {
+public:
+    // 定时器挂钩：同时也是槽位链表的节点
+    struct Hook {
+        Hook* prev = nullptr;                         // 链表中的前一个节点
+        Hook* next = nullptr;                         // 链表中的后一个节点，为空表示未登记
+        std::uint64_t expiry = 0;                     // 到期的 tick
+        T* owner = nullptr;                           // 到期时回调的对象
+
+        bool linked() const noexcept {
+            return next != nullptr;
+        }
+    };
+
+    static constexpr unsigned slot_bits = 6;          // 每层槽位数的位数
+    static constexpr std::size_t slots = std::size_t(1) << slot_bits;  // 每层槽位数
+    static constexpr std::size_t levels = 4;          // 层数，可表示 2^24 个 tick 以内的期限
+    static constexpr std::uint64_t max_delay = (std::uint64_t(1) << (slot_bits * levels)) - 1;
+
+private:
+    std::chrono::milliseconds const tick_;            // 每个 tick 的时长
+    std::array<std::array<Hook, slots>, levels> wheel_;  // 每个槽位一个哨兵节点，链表为环形
+    Hook expired_;                                    // 本次推进中到期、尚未回调的定时器
+    std::uint64_t now_ = 0;                           // 已经推进到的 tick
+    std::size_t size_ = 0;                            // 已登记的定时器数
+
+public:
+    explicit TimerWheel(std::chrono::milliseconds tick)
+        : tick_(tick.count() > 0 ? tick : std::chrono::milliseconds(1)) {
+        for(auto& level : wheel_) {
+            for(auto& head : level) {
+                head.prev = head.next = &head;
+            }
+        }
+        expired_.prev = expired_.next = &expired_;
+    }
+
+    // 哨兵节点互相引用，不能复制或移动
+    TimerWheel(TimerWheel const&) = delete;
+    TimerWheel& operator=(TimerWheel const&) = delete;
+
+    std::chrono::milliseconds tick() const noexcept {
+        return tick_;
+    }
+
+    // 当前的 tick
+    std::uint64_t now() const noexcept {
+        return now_;
+    }
+
+    // 已登记的定时器数
+    std::size_t size() const noexcept {
+        return size_;
+    }
+
+    // 把时长换算成 tick 数（向上取整），0 仍为 0
+    template<class Rep, class Period>
+    std::uint64_t ticks(std::chrono::duration<Rep, Period> d) const noexcept {
+        auto const ms = std::chrono::duration_cast<std::chrono::milliseconds>(d).count();
+        if(ms <= 0) {
+            return 0;
+        }
+        return (static_cast<std::uint64_t>(ms) + tick_.count() - 1) / tick_.count();
+    }
+
+    // 在 delay 个 tick 之后到期（至少 1 个），已登记的挂钩先取消
+    void schedule(Hook& hook, T* owner, std::uint64_t delay) noexcept {
+        schedule_at(hook, owner, now_ + (delay > 0 ? delay : 1));
+    }
+
+    // 在第 expiry 个 tick 到期；已经过去的时刻按下一个 tick 处理
+    void schedule_at(Hook& hook, T* owner, std::uint64_t expiry) noexcept {
+        cancel(hook);
+        hook.owner = owner;
+        hook.expiry = expiry > now_ ? expiry : now_ + 1;
+        link(hook);
+        ++size_;
+    }
+
+    // 取消定时器，未登记时什么也不做
+    void cancel(Hook& hook) noexcept {
+        if(hook.linked()) {
+            unlink(hook);
+            --size_;
+        }
+    }
+
+    // 推进到第 target 个 tick，依次回调期间到期的定时器
+    void advance(std::uint64_t target) {
+        while(now_ < target) {
+            step();
+        }
+    }
+
+private:
+    // 推进一个 tick：先把转完一圈的上层槽位下放，再回调第 0 层当前槽位中的全部定时器
+    void step() {
+        ++now_;
+        for(std::size_t level = 1; level < levels; ++level) {
+            if((now_ & ((std::uint64_t(1) << (slot_bits * level)) - 1)) != 0) {
+                break;
+            }
+            cascade(level, (now_ >> (slot_bits * level)) & (slots - 1));
+        }
+
+        // 先整体移到 expired_，回调中新登记的定时器不会在本 tick 内再次被处理
+        splice(wheel_[0][now_ & (slots - 1)], expired_);
+        while(expired_.next != &expired_) {
+            auto& hook = *expired_.next;
+            unlink(hook);
+            --size_;
+            hook.owner->on_timer();
+        }
+    }
+
+    // 把第 level 层 index 号槽位中的定时器按剩余时长重新放入更低的层
+    void cascade(std::size_t level, std::size_t index) noexcept {
+        auto& head = wheel_[level][index];
+        while(head.next != &head) {
+            auto& hook = *head.next;
+            unlink(hook);
+            link(hook);
+        }
+    }
+
+    // 按距到期的 tick 数选择层与槽位，超出范围的期限按最大值处理
+    void link(Hook& hook) noexcept {
+        auto delay = hook.expiry - now_;
+        if(delay > max_delay) {
+            delay = max_delay;
+            hook.expiry = now_ + delay;
+        }
+        std::size_t level = 0;
+        while(level + 1 < levels && delay >= (std::uint64_t(1) << (slot_bits * (level + 1)))) {
+            ++level;
+        }
+        auto& head = wheel_[level][(hook.expiry >> (slot_bits * level)) & (slots - 1)];
+        hook.prev = head.prev;
+        hook.next = &head;
+        head.prev->next = &hook;
+        head.prev = &hook;
+    }
+
+    static void unlink(Hook& hook) noexcept {
+        hook.prev->next = hook.next;
+        hook.next->prev = hook.prev;
+        hook.prev = hook.next = nullptr;
+    }
+
+    // 把 from 链表中的全部节点移到空链表 to
+    static void splice(Hook& from, Hook& to) noexcept {
+        if(from.next == &from) {
+            return;
+        }
+        to.next = from.next;
+        to.prev = from.prev;
+        to.next->prev = &to;
+        to.prev->next = &to;
+        from.prev = from.next = &from;
+    }
+};
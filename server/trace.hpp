@@ -0,0 +1,95 @@
+#pragma once
+
+#include "logger.hpp"                    // 慢消息输出
+#include "metrics.hpp"                   // 各阶段直方图
+
+#include <atomic>                        // 原子变量
+#include <chrono>                        // 时间戳
+#include <cstddef>                       // std::size_t
+#include <cstdint>                       // 定长整数类型
+
+// 消息延迟追踪（--trace=1 时启用）
+//
+// 每条被追踪的消息带一个 MessageTrace，在四个时刻打点：
+//   1. 读取完成（Session::on_read）
+//   2. 开始扇出（Session::publish 调用 FanOut 之前）
+//   3. 每个接收者入队（OutboundQueue::push）
+//   4. 每个接收者写完（OutboundQueue::complete_write）
+// 各阶段耗时记入 metrics 直方图。追踪对象随帧一起存放在每个接收者的发送队列里，
+// 最后一个接收者写完（或丢弃）时释放，析构时记录端到端耗时，超过阈值则输出该消息的追踪。
+// 未启用追踪时不创建追踪对象，各处只多一次空指针判断。
+namespace tracing {
+
+using clock = std::chrono::steady_clock;
+
+class MessageTrace {
+    clock::time_point read_;                          // 读取完成的时刻，其余时刻都相对它记录
+    std::chrono::nanoseconds threshold_;              // 慢消息阈值
+    std::size_t bytes_;                               // 消息负载字节数
+    std::int64_t fanout_ns_ = 0;                      // 开始扇出的时刻；只在发送者的线程上写入，先于扇出
+    std::atomic<std::uint32_t> recipients_{0};        // 已入队的接收者数
+    std::atomic<std::int64_t> last_enqueue_ns_{0};    // 最晚一次入队的时刻
+    std::atomic<std::int64_t> last_write_ns_{-1};     // 最晚一次写完的时刻，-1 表示没有接收者写完
+
+public:
+    MessageTrace(clock::time_point read, std::chrono::nanoseconds threshold, std::size_t bytes)
+        : read_(read), threshold_(threshold), bytes_(bytes) {}
+
+    MessageTrace(MessageTrace const&) = delete;
+    MessageTrace& operator=(MessageTrace const&) = delete;
+
+    // 析构时所有接收者都已写完或丢弃了这条消息
+    ~MessageTrace() {
+        auto const total = last_write_ns_.load(std::memory_order_relaxed);
+        if(total < 0) {
+            return;
+        }
+        metrics::observe(metrics::Hist::trace_total_ns, static_cast<std::uint64_t>(total));
+        if(total >= threshold_.count()) {
+            LOG_WARN << "慢消息: " << bytes_ << " 字节，接收者 "
+                     << recipients_.load(std::memory_order_relaxed)
+                     << "，读取→最后写完 " << total / 1000 << " us（读取→扇出 " << fanout_ns_ / 1000
+                     << " us，读取→最晚入队 " << last_enqueue_ns_.load(std::memory_order_relaxed) / 1000
+                     << " us）";
+        }
+    }
+
+    // 发送者线程：开始扇出
+    void fanout_started() {
+        fanout_ns_ = since_read(clock::now());
+        metrics::observe(metrics::Hist::trace_dispatch_ns, static_cast<std::uint64_t>(fanout_ns_));
+    }
+
+    // 接收者线程：帧进入接收者的发送队列
+    void enqueued(clock::time_point now) {
+        auto const at = since_read(now);
+        recipients_.fetch_add(1, std::memory_order_relaxed);
+        raise(last_enqueue_ns_, at);
+        metrics::observe(metrics::Hist::trace_enqueue_ns, clamp(at - fanout_ns_));
+    }
+
+    // 接收者线程：帧已写入 socket，enqueued 为它入队的时刻
+    void written(clock::time_point enqueued, clock::time_point now) {
+        raise(last_write_ns_, since_read(now));
+        metrics::observe(metrics::Hist::trace_write_ns,
+            clamp(std::chrono::duration_cast<std::chrono::nanoseconds>(now - enqueued).count()));
+    }
+
+private:
+    std::int64_t since_read(clock::time_point t) const noexcept {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(t - read_).count();
+    }
+
+    static std::uint64_t clamp(std::int64_t ns) noexcept {
+        return ns > 0 ? static_cast<std::uint64_t>(ns) : 0;
+    }
+
+    static void raise(std::atomic<std::int64_t>& target, std::int64_t value) noexcept {
+        auto current = target.load(std::memory_order_relaxed);
+        while(current < value &&
+              !target.compare_exchange_weak(current, value, std::memory_order_relaxed)) {
+        }
+    }
+};
+
+} // namespace tracing
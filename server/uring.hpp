@@ -0,0 +1,472 @@
+#pragma once
+
+#include "metrics.hpp"                   // 提交次数统计
+
+#include <boost/asio/io_context.hpp>     // 所属事件循环
+#include <boost/asio/post.hpp>           // 每批请求提交一次
+#include <boost/asio/posix/stream_descriptor.hpp>  // 在事件循环上等待 eventfd
+#include <atomic>                        // 与内核共享的环形队列下标
+#include <cerrno>                        // errno
+#include <cstdint>                       // 定长整数类型
+#include <cstring>                       // std::memset、std::strerror
+#include <memory>                        // std::unique_ptr
+#include <string>                        // 创建失败的原因
+
+#if defined(__linux__) && __has_include(<linux/io_uring.h>)
+#define WEBSOCKET_HAS_IO_URING 1
+#include <linux/io_uring.h>              // io_uring 的内核接口
+#include <netinet/in.h>                  // 探测用的回环监听地址
+#include <sys/eventfd.h>                 // 完成通知
+#include <sys/mman.h>                    // 映射提交与完成队列
+#include <sys/socket.h>                  // msghdr
+#include <sys/syscall.h>                 // io_uring_setup / enter / register
+#include <unistd.h>                      // syscall、close
+#else
+#define WEBSOCKET_HAS_IO_URING 0
+struct msghdr;
+#endif
+
+// io_uring 后端：每个事件循环一个提交 / 完成队列
+//
+// 直接使用系统调用，不依赖 liburing；事件循环本身仍是 Asio 的 io_context（epoll），
+// io_uring 只承担 socket 的数据读写与接受连接：
+//   - 请求先填入提交队列，第一个请求向事件循环 post 一次提交任务，同一轮处理中
+//     各会话的读写（例如一次广播扇出的全部写入）由一次 io_uring_enter 一并提交；
+//   - 完成队列注册了一个 eventfd，事件循环像等待普通 socket 一样等待它，
+//     可读时一次取空完成队列，在事件循环线程上逐个回调。
+// 只能在所属事件循环的线程上使用（构造期间除外），不加锁。
+namespace uring {
+
+// 一个已提交的请求；完成时在事件循环线程上以内核返回值（负数为 -errno）与完成标志回调
+class Operation {
+public:
+    virtual void complete(int result, unsigned flags) = 0;
+
+protected:
+    ~Operation() = default;
+};
+
+class Loop {
+    using executor_type = boost::asio::io_context::executor_type;
+
+    boost::asio::io_context& ioc_;                    // 所属事件循环
+    boost::asio::posix::basic_stream_descriptor<executor_type> event_;  // 完成通知的 eventfd
+    bool submit_scheduled_ = false;                   // 已 post 提交任务、尚未执行
+    unsigned pending_ = 0;                            // 已填入提交队列、尚未提交的请求数
+
+#if WEBSOCKET_HAS_IO_URING
+    int ring_fd_ = -1;                                // io_uring 实例
+    void* sq_ring_ = nullptr;                         // 提交队列的映射
+    std::size_t sq_ring_size_ = 0;
+    void* cq_ring_ = nullptr;                         // 完成队列的映射（单次映射时与提交队列相同）
+    std::size_t cq_ring_size_ = 0;
+    io_uring_sqe* sqes_ = nullptr;                    // 请求数组的映射
+    std::size_t sqes_size_ = 0;
+
+    unsigned* sq_head_ = nullptr;                     // 内核已取走的位置
+    unsigned* sq_tail_ = nullptr;                     // 已发布的位置
+    unsigned* sq_flags_ = nullptr;                    // 内核设置的提交队列标志
+    unsigned* sq_array_ = nullptr;                    // 提交队列中的请求下标
+    unsigned sq_mask_ = 0;
+    unsigned sq_entries_ = 0;
+    unsigned* cq_head_ = nullptr;                     // 已处理的完成位置
+    unsigned* cq_tail_ = nullptr;                     // 内核写入的完成位置
+    unsigned cq_mask_ = 0;
+    io_uring_cqe* cqes_ = nullptr;                    // 完成数组
+    bool multishot_accept_ = false;                   // 内核支持多次接受（5.19 起）
+#endif
+
+    explicit Loop(boost::asio::io_context& ioc)
+        : ioc_(ioc), event_(ioc.get_executor()) {}
+
+public:
+    Loop(Loop const&) = delete;
+    Loop& operator=(Loop const&) = delete;
+
+    // 为 ioc 创建容量为 entries 的 io_uring；内核或平台不支持时返回空，并在 error 中说明原因
+    static std::unique_ptr<Loop> create(boost::asio::io_context& ioc, unsigned entries, std::string& error) {
+        std::unique_ptr<Loop> loop(new Loop(ioc));
+#if WEBSOCKET_HAS_IO_URING
+        if(!loop->setup(entries, error)) {
+            return nullptr;
+        }
+        return loop;
+#else
+        (void)entries;
+        error = "当前平台不支持 io_uring";
+        return nullptr;
+#endif
+    }
+
+    // 开始在事件循环上等待完成；全部事件循环的 io_uring 都创建成功后再调用
+    void start() {
+#if WEBSOCKET_HAS_IO_URING
+        wait();
+#endif
+    }
+
+    ~Loop() {
+#if WEBSOCKET_HAS_IO_URING
+        // 关闭实例时内核取消仍在进行的请求；事件循环此时已经停止，不再回调
+        if(sqes_) {
+            ::munmap(sqes_, sqes_size_);
+        }
+        if(cq_ring_ && cq_ring_ != sq_ring_) {
+            ::munmap(cq_ring_, cq_ring_size_);
+        }
+        if(sq_ring_) {
+            ::munmap(sq_ring_, sq_ring_size_);
+        }
+        if(ring_fd_ >= 0) {
+            ::close(ring_fd_);
+        }
+#endif
+    }
+
+    // 从 fd 接收到 msg 描述的缓冲区
+    void recvmsg(int fd, ::msghdr* msg, Operation* op) {
+#if WEBSOCKET_HAS_IO_URING
+        auto* sqe = next_sqe();
+        sqe->opcode = IORING_OP_RECVMSG;
+        sqe->fd = fd;
+        sqe->addr = reinterpret_cast<std::uint64_t>(msg);
+        sqe->len = 1;
+        sqe->user_data = reinterpret_cast<std::uint64_t>(op);
+        publish();
+#else
+        (void)fd; (void)msg; (void)op;
+#endif
+    }
+
+    // 把 msg 描述的缓冲区发送到 fd；对端已关闭时返回 -EPIPE 而不是产生 SIGPIPE
+    void sendmsg(int fd, ::msghdr const* msg, Operation* op) {
+#if WEBSOCKET_HAS_IO_URING
+        auto* sqe = next_sqe();
+        sqe->opcode = IORING_OP_SENDMSG;
+        sqe->fd = fd;
+        sqe->addr = reinterpret_cast<std::uint64_t>(msg);
+        sqe->len = 1;
+        sqe->msg_flags = MSG_NOSIGNAL;
+        sqe->user_data = reinterpret_cast<std::uint64_t>(op);
+        publish();
+#else
+        (void)fd; (void)msg; (void)op;
+#endif
+    }
+
+    // 在监听 socket 上接受连接：每个新连接产生一个完成（结果为新 socket），
+    // 完成标志中没有 more() 时请求已经结束，需要重新提交。
+    // 内核支持时一次请求持续接受（multishot），否则每个连接一次请求
+    void accept(int fd, Operation* op) {
+#if WEBSOCKET_HAS_IO_URING
+        auto* sqe = next_sqe();
+        sqe->opcode = IORING_OP_ACCEPT;
+        sqe->fd = fd;
+        if(multishot_accept_) {
+            sqe->ioprio = IORING_ACCEPT_MULTISHOT;
+        }
+        sqe->accept_flags = SOCK_CLOEXEC;
+        sqe->user_data = reinterpret_cast<std::uint64_t>(op);
+        publish();
+#else
+        (void)fd; (void)op;
+#endif
+    }
+
+    // 接受连接是否使用多次接受
+    bool multishot_accept() const noexcept {
+#if WEBSOCKET_HAS_IO_URING
+        return multishot_accept_;
+#else
+        return false;
+#endif
+    }
+
+    // 完成标志表示同一请求还会产生更多完成
+    static bool more(unsigned flags) noexcept {
+#if WEBSOCKET_HAS_IO_URING
+        return (flags & IORING_CQE_F_MORE) != 0;
+#else
+        (void)flags;
+        return false;
+#endif
+    }
+
+    // 取消 op；立即提交，保证在调用方随后关闭 socket 之前送达内核。
+    // 被取消的请求以 -ECANCELED 完成（已经完成的照常回调）
+    void cancel(Operation* op) {
+#if WEBSOCKET_HAS_IO_URING
+        auto* sqe = next_sqe();
+        sqe->opcode = IORING_OP_ASYNC_CANCEL;
+        sqe->fd = -1;
+        sqe->addr = reinterpret_cast<std::uint64_t>(op);
+        sqe->user_data = 0;
+        publish();
+        submit();
+#else
+        (void)op;
+#endif
+    }
+
+    // 提交全部已填入的请求
+    void submit() {
+        submit_scheduled_ = false;
+#if WEBSOCKET_HAS_IO_URING
+        while(pending_ > 0) {
+            auto const submitted = enter(pending_, 0);
+            if(submitted > 0) {
+                pending_ -= static_cast<unsigned>(submitted);
+                metrics::add(metrics::Counter::uring_submits);
+                metrics::add(metrics::Counter::uring_requests, static_cast<std::uint64_t>(submitted));
+                continue;
+            }
+            if(submitted < 0 && (errno == EINTR)) {
+                continue;
+            }
+            if(submitted < 0 && (errno == EBUSY || errno == EAGAIN)) {
+                // 完成队列积压：先处理完成，下一轮再提交剩余的请求
+                reap();
+                schedule_submit();
+            }
+            return;
+        }
+#endif
+    }
+
+private:
+#if WEBSOCKET_HAS_IO_URING
+    static int setup_ring(unsigned entries, io_uring_params& params) {
+        return static_cast<int>(::syscall(__NR_io_uring_setup, entries, &params));
+    }
+
+    int enter(unsigned to_submit, unsigned flags, unsigned min_complete = 0) {
+        return static_cast<int>(::syscall(__NR_io_uring_enter, ring_fd_, to_submit, min_complete, flags, nullptr, 0));
+    }
+
+    template<class T>
+    T* at(void* base, unsigned offset) noexcept {
+        return reinterpret_cast<T*>(static_cast<char*>(base) + offset);
+    }
+
+    static unsigned load(unsigned const* p) noexcept {
+        return __atomic_load_n(p, __ATOMIC_ACQUIRE);
+    }
+
+    static void store(unsigned* p, unsigned value) noexcept {
+        __atomic_store_n(p, value, __ATOMIC_RELEASE);
+    }
+
+    bool setup(unsigned entries, std::string& error) {
+        io_uring_params params;
+        std::memset(&params, 0, sizeof(params));
+        params.flags = IORING_SETUP_CLAMP;
+        ring_fd_ = setup_ring(entries, params);
+        if(ring_fd_ < 0) {
+            error = std::string("io_uring_setup: ") + std::strerror(errno);
+            return false;
+        }
+        if(!(params.features & IORING_FEAT_NODROP)) {
+            error = "内核不保证完成事件不丢失（需要 5.5 以上）";
+            return false;
+        }
+
+        sq_ring_size_ = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+        cq_ring_size_ = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+        bool const single = params.features & IORING_FEAT_SINGLE_MMAP;
+        if(single && cq_ring_size_ > sq_ring_size_) {
+            sq_ring_size_ = cq_ring_size_;
+        }
+        sq_ring_ = ::mmap(nullptr, sq_ring_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                          ring_fd_, IORING_OFF_SQ_RING);
+        if(sq_ring_ == MAP_FAILED) {
+            sq_ring_ = nullptr;
+            error = std::string("映射提交队列失败: ") + std::strerror(errno);
+            return false;
+        }
+        if(single) {
+            cq_ring_ = sq_ring_;
+        } else {
+            cq_ring_ = ::mmap(nullptr, cq_ring_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                              ring_fd_, IORING_OFF_CQ_RING);
+            if(cq_ring_ == MAP_FAILED) {
+                cq_ring_ = nullptr;
+                error = std::string("映射完成队列失败: ") + std::strerror(errno);
+                return false;
+            }
+        }
+        sqes_size_ = params.sq_entries * sizeof(io_uring_sqe);
+        void* sqes = ::mmap(nullptr, sqes_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                            ring_fd_, IORING_OFF_SQES);
+        if(sqes == MAP_FAILED) {
+            error = std::string("映射请求数组失败: ") + std::strerror(errno);
+            return false;
+        }
+        sqes_ = static_cast<io_uring_sqe*>(sqes);
+
+        sq_head_ = at<unsigned>(sq_ring_, params.sq_off.head);
+        sq_tail_ = at<unsigned>(sq_ring_, params.sq_off.tail);
+        sq_flags_ = at<unsigned>(sq_ring_, params.sq_off.flags);
+        sq_array_ = at<unsigned>(sq_ring_, params.sq_off.array);
+        sq_mask_ = *at<unsigned>(sq_ring_, params.sq_off.ring_mask);
+        sq_entries_ = *at<unsigned>(sq_ring_, params.sq_off.ring_entries);
+        cq_head_ = at<unsigned>(cq_ring_, params.cq_off.head);
+        cq_tail_ = at<unsigned>(cq_ring_, params.cq_off.tail);
+        cq_mask_ = *at<unsigned>(cq_ring_, params.cq_off.ring_mask);
+        cqes_ = at<io_uring_cqe>(cq_ring_, params.cq_off.cqes);
+        multishot_accept_ = probe_multishot_accept();
+
+        int const efd = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        if(efd < 0) {
+            error = std::string("eventfd: ") + std::strerror(errno);
+            return false;
+        }
+        boost::system::error_code ec;
+        event_.assign(efd, ec);
+        if(ec) {
+            ::close(efd);
+            error = "eventfd: " + ec.message();
+            return false;
+        }
+        if(::syscall(__NR_io_uring_register, ring_fd_, IORING_REGISTER_EVENTFD, &efd, 1) != 0) {
+            error = std::string("注册 eventfd 失败: ") + std::strerror(errno);
+            return false;
+        }
+        return true;
+    }
+
+    // 多次接受需要 5.19 以上，无法从 features 得知：在临时的回环监听 socket 上提交一次多次接受再取消它。
+    // 旧内核在提交时即以 -EINVAL 拒绝该标志，支持的内核则以 -ECANCELED 结束请求。
+    // 在 setup 中同步执行，此时尚未注册 eventfd，也没有其他请求
+    bool probe_multishot_accept() {
+        int const fd = ::socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        if(fd < 0) {
+            return false;
+        }
+        ::sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        int accept_result = -EINVAL;
+        if(::bind(fd, reinterpret_cast<::sockaddr*>(&addr), sizeof(addr)) == 0 && ::listen(fd, 1) == 0) {
+            // 逐条提交，容量为 1 的提交队列也能完成探测
+            std::uint64_t const probe = 1;
+            auto* sqe = next_sqe();
+            sqe->opcode = IORING_OP_ACCEPT;
+            sqe->fd = fd;
+            sqe->ioprio = IORING_ACCEPT_MULTISHOT;
+            sqe->user_data = probe;
+            stage();
+            bool submitted = enter(1, 0) == 1;
+            if(submitted) {
+                sqe = next_sqe();
+                sqe->opcode = IORING_OP_ASYNC_CANCEL;
+                sqe->fd = -1;
+                sqe->addr = probe;
+                sqe->user_data = probe + 1;
+                stage();
+                submitted = enter(1, 0) == 1;
+            }
+
+            // 等到接受请求结束；取消请求的完成一并取走
+            for(unsigned completed = 0; submitted && completed < 2;) {
+                if(*cq_head_ == load(cq_tail_)) {
+                    if(enter(0, IORING_ENTER_GETEVENTS, 1) < 0 && errno != EINTR) {
+                        break;
+                    }
+                    continue;
+                }
+                auto const head = *cq_head_;
+                auto const& cqe = cqes_[head & cq_mask_];
+                if(cqe.user_data == probe && !(cqe.flags & IORING_CQE_F_MORE)) {
+                    accept_result = cqe.res;
+                }
+                store(cq_head_, head + 1);
+                ++completed;
+            }
+        }
+        ::close(fd);
+        return accept_result == -ECANCELED;
+    }
+
+    // 取得一个空闲的请求槽位；提交队列已满时先提交已有的请求
+    io_uring_sqe* next_sqe() {
+        auto const tail = *sq_tail_;
+        while(tail - load(sq_head_) >= sq_entries_) {
+            submit();
+            if(tail - load(sq_head_) >= sq_entries_) {
+                reap();
+            }
+        }
+        auto* sqe = &sqes_[tail & sq_mask_];
+        std::memset(sqe, 0, sizeof(*sqe));
+        return sqe;
+    }
+
+    // 发布刚填好的请求，并安排本轮处理结束后提交
+    void publish() {
+        stage();
+        ++pending_;
+        schedule_submit();
+    }
+
+    // 把刚填好的请求放入提交队列
+    void stage() {
+        auto const tail = *sq_tail_;
+        sq_array_[tail & sq_mask_] = tail & sq_mask_;
+        store(sq_tail_, tail + 1);
+    }
+
+    void schedule_submit() {
+        if(submit_scheduled_) {
+            return;
+        }
+        submit_scheduled_ = true;
+        boost::asio::post(ioc_, [this] { submit(); });
+    }
+
+    // 等待 eventfd 可读：内核每写入一个完成就使它可读
+    // 每次唤醒处理一整批完成，等待本身使用 Asio 默认（按线程缓存）的处理器内存；
+    // 事件循环池析构时才销毁的处理器因此不会引用已经析构的本对象
+    void wait() {
+        event_.async_wait(
+            boost::asio::posix::descriptor_base::wait_read,
+            [this](boost::system::error_code ec) {
+                if(ec) {
+                    return;
+                }
+                // 先清零计数再取完成，之后到达的完成会让 eventfd 再次可读
+                std::uint64_t value;
+                while(::read(event_.native_handle(), &value, sizeof(value)) < 0 && errno == EINTR) {
+                }
+                reap();
+                wait();
+            });
+    }
+
+    // 取空完成队列；每个完成先出队再回调，回调中可以提交新的请求甚至再次取完成
+    void reap() {
+        for(;;) {
+            auto const head = *cq_head_;
+            if(head == load(cq_tail_)) {
+                // 内核暂存了放不下的完成时，进入内核让它们写入完成队列
+                if(load(sq_flags_) & IORING_SQ_CQ_OVERFLOW) {
+                    enter(0, IORING_ENTER_GETEVENTS);
+                    if(*cq_head_ != load(cq_tail_)) {
+                        continue;
+                    }
+                }
+                return;
+            }
+            auto const& cqe = cqes_[head & cq_mask_];
+            auto* op = reinterpret_cast<Operation*>(cqe.user_data);
+            auto const result = cqe.res;
+            auto const flags = cqe.flags;
+            store(cq_head_, head + 1);
+            if(op) {
+                op->complete(result, flags);
+            }
+        }
+    }
+#endif
+};
+
+} // namespace uring
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <cstddef>                       // std::size_t
+#include <cstdint>                       // 定长整数类型
+#include <cstring>                       // std::memcpy
+#include <string>                        // std::string 支持
+#include <string_view>                   // std::string_view 支持
+
+// 服务端 → 客户端 WebSocket 帧的编码工具（RFC 6455 第 5.2 节）
+// 服务端发出的帧不带掩码，因此同一条消息编码出的字节对所有接收者都完全相同，
+// 广播时只需编码一次即可直接写入每个连接的 tcp_stream
+namespace frame {
+
+// 帧操作码
+enum class opcode : std::uint8_t {
+    cont   = 0x0,
+    text   = 0x1,
+    binary = 0x2,
+    close  = 0x8,
+    ping   = 0x9,
+    pong   = 0xA
+};
+
+// 帧头第一个字节中的 RSV1 位，permessage-deflate 用它标记压缩过的消息
+constexpr std::uint8_t rsv1 = 0x40;
+
+// 无掩码帧头的最大长度：2 字节基本头 + 8 字节扩展长度
+constexpr std::size_t max_header_size = 10;
+
+// 将 FIN=1 的单帧头写入 out，返回帧头长度
+// out 至少需要 max_header_size 字节
+inline std::size_t encode_header(opcode op, std::uint64_t payload_size, unsigned char* out) {
+    out[0] = static_cast<unsigned char>(0x80 | static_cast<std::uint8_t>(op));
+
+    if(payload_size < 126) {
+        out[1] = static_cast<unsigned char>(payload_size);
+        return 2;
+    }
+
+    if(payload_size <= 0xFFFF) {
+        out[1] = 126;
+        out[2] = static_cast<unsigned char>(payload_size >> 8);
+        out[3] = static_cast<unsigned char>(payload_size);
+        return 4;
+    }
+
+    out[1] = 127;
+    for(int i = 0; i < 8; ++i) {
+        out[2 + i] = static_cast<unsigned char>(payload_size >> (56 - 8 * i));
+    }
+    return 10;
+}
+
+// 编码一条完整的帧（帧头 + 负载），只进行一次内存分配
+inline std::string encode(opcode op, std::string_view payload) {
+    unsigned char header[max_header_size];
+    auto const header_size = encode_header(op, payload.size(), header);
+
+    std::string out;
+    out.resize(header_size + payload.size());
+    std::memcpy(&out[0], header, header_size);
+    if(!payload.empty()) {
+        std::memcpy(&out[header_size], payload.data(), payload.size());
+    }
+    return out;
+}
+
+} // namespace frame
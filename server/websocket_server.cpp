@@ -1,16 +1,43 @@
 #define BOOST_BEAST_USE_STD_STRING_VIEW  // 使用标准库的 std::string_view，以便 Beast 使用
 
 #include <boost/beast/core.hpp>          // 引入 Boost.Beast 核心功能
+#include <boost/beast/http.hpp>          // 升级前的 HTTP 请求（/metrics）
 #include <boost/beast/websocket.hpp>     // 引入 WebSocket 支持
+#include <boost/asio/dispatch.hpp>       // 切换到会话所属的事件循环
 #include <boost/asio/ip/tcp.hpp>         // 引入 Boost.Asio TCP 支持
+#include <boost/asio/steady_timer.hpp>   // 定时输出统计
+#include <atomic>                        // 只提示一次的标志
+#include <chrono>                        // 计时与超时
 #include <cstdlib>                       // 引入通用工具（如 EXIT_SUCCESS）
 #include <functional>                    // 引入 std::function 等
-#include <iostream>                      // 标准输入输出流
+#include <iostream>                      // 标准输入输出流（只用于启动前的参数错误）
 #include <memory>                        // 智能指针支持
 #include <string>                        // std::string 支持
-#include <set>                           // std::set 容器
+#include <map>                           // std::map 容器
+#include <optional>                      // std::optional
 #include <thread>                        // 多线程支持
-#include <mutex>                         // 互斥量支持
+#include <vector>                        // std::vector 容器
+#include <unistd.h>                      // ::close（改派连接失败时关闭）
+#include "fanout.hpp"                    // 跨事件循环的广播
+#include "frame_buffer.hpp"              // 池化的共享帧缓冲区
+#include "frame_stream.hpp"              // 支持原始帧写入的下层流
+#include "core_mesh.hpp"                 // 无共享模式的核心间消息网格
+#include "cpu_affinity.hpp"              // 线程绑定 CPU 与连接引导
+#include "coroutine.hpp"                 // 协程会话路径的完成令牌
+#include "handler_allocator.hpp"         // 会话的处理器内存
+#include "io_context_pool.hpp"           // 事件循环池
+#include "logger.hpp"                    // 异步日志
+#include "metrics.hpp"                   // 按线程统计、采集时汇总的指标
+#include "outbound_queue.hpp"            // 有界发送队列与背压策略
+#include "permessage_deflate.hpp"        // 压缩协商与广播帧压缩
+#include "room_index.hpp"                // 房间（主题）索引
+#include "server_config.hpp"             // 服务器配置
+#include "session_registry.hpp"          // 分片会话注册表
+#include "slab_allocator.hpp"            // 会话对象的 slab 分配
+#include "timer_wheel.hpp"               // 超时与保活 ping 的时间轮
+#include "trace.hpp"                     // 消息延迟追踪
+#include "uring.hpp"                     // io_uring 后端
+#include "websocket_frame.hpp"           // 服务端帧编码
 
 // 为不同模块定义别名，简化后续代码书写
 namespace beast = boost::beast;
@@ -19,156 +46,1147 @@ namespace websocket = beast::websocket;
 namespace net = boost::asio;
 using tcp = boost::asio::ip::tcp;
 
+// 新连接自动加入的房间，未切换房间时消息发往这里，与过去“发给所有人”的行为一致
+constexpr char const* default_room = "lobby";
+
+class Session;
+
+// 所有会话共享的服务器级状态，由 Server 持有并在其生命周期内保持有效
+struct ServerContext {
+    ServerConfig const& config;                        // 服务器配置
+    SessionRegistry<Session>& sessions;                // 全部会话注册表，按事件循环分组
+    RoomIndex<Session>& rooms;                         // 房间索引
+    FanOut<Session>& fanout;                           // 跨事件循环的广播
+    CoreMesh<Session>* mesh;                           // 无共享模式下代替 rooms 与 fanout，其他模式为空
+    std::vector<std::unique_ptr<TimerWheel<Session>>> const& timers;  // 每个事件循环一个时间轮
+    std::vector<std::unique_ptr<uring::Loop>> const& urings;  // io_uring 后端时每个事件循环一个，epoll 时为空
+};
+
 // 会话类，表示与单个客户端的 WebSocket 连接
+// 会话固定属于一个事件循环（socket 绑定在该循环的 io_context 上），
+// 除构造外的所有成员函数都只在该循环的线程上执行
+//
+// 连接建立后先读取一个 HTTP 请求：升级请求交给 Beast 完成 WebSocket 握手，
+// 其余请求按普通 HTTP 应答（GET /metrics 返回 Prometheus 指标，其他路径返回 404），
+// 因此指标与 WebSocket 共用同一个端口和接受器。
+//
+// 房间控制协议（以 '/' 开头的文本消息）：
+//   /join <房间名>   加入房间并将其设为当前房间，之后的普通消息只发给该房间成员
+//   /leave <房间名>  离开房间
 class Session : public std::enable_shared_from_this<Session> {
-    websocket::stream<beast::tcp_stream> ws_;          // WebSocket 流，用于读写消息
-    beast::flat_buffer buffer_;                        // 缓冲区，用于存储接收的数据
-    std::set<std::shared_ptr<Session>>& sessions_;     // 全部会话集合引用，用于广播
-    std::mutex& sessions_mutex_;                       // 保护 sessions_ 的互斥量引用
+    // 会话在一个房间中的成员资格
+    struct Membership {
+        std::shared_ptr<Room<Session>> room;           // 所在房间，发布时直接使用，不再查索引
+        std::uint64_t id = 0;                          // 无共享模式下的房间编号（此时 room 为空）
+        RegistryHook hook;                             // 在房间成员注册表中的位置
+    };
+
+    HandlerMemory handler_memory_;                     // 异步操作的处理器内存，最先构造、最后析构
+    websocket::stream<FrameStream> ws_;                // WebSocket 流，用于读消息；广播帧经由下层流直接写出
+    beast::flat_buffer buffer_;                        // 升级前 HTTP 请求的读缓冲区
+    boost::intrusive_ptr<FrameBuffer> inbound_;        // 正在读取的消息，只在读取进行中向缓冲池借用
+    std::optional<http::request_parser<http::empty_body>> parser_;  // 升级前的 HTTP 请求，握手完成后释放
+    bool served_http_ = false;                         // 本连接已应答过普通 HTTP 请求（keep-alive）
+    std::size_t loop_;                                 // 所属事件循环的下标
+    ServerContext& ctx_;                               // 服务器级共享状态
+    RegistryHook registry_hook_;                       // 本会话在全部会话注册表中的位置
+    std::map<std::string, Membership> rooms_;          // 已加入的房间；map 节点地址稳定，挂钩可被注册表引用
+    Membership* current_ = nullptr;                    // 当前房间的成员资格，普通消息发往这里；为空表示未在任何房间
+    OutboundQueue queue_;                              // 有界发送队列，编码好的帧由所有接收者共享
+    bool closing_ = false;                             // 已因背压断开，不再接收新的待发送消息
+    bool established_ = false;                         // WebSocket 握手已完成，定时器从握手期限转为空闲检查
+    bool ping_sent_ = false;                           // 本轮空闲中已发出保活 ping
+    std::uint64_t last_activity_ = 0;                  // 最近一次收到数据或控制帧的 tick
+    TimerWheel<Session>::Hook timer_;                  // 在本循环时间轮中的挂钩：握手期限或下一次空闲检查
+    int deflate_window_ = 0;                           // 协商到的服务端压缩窗口位数，0 表示未协商压缩
 
 public:
-    // 构造函数：接收一个已连接的 socket、会话集合和互斥量引用
-    explicit Session(tcp::socket&& socket, std::set<std::shared_ptr<Session>>& sessions, std::mutex& mutex)
-        : ws_(std::move(socket)), sessions_(sessions), sessions_mutex_(mutex) {}
+    // 构造函数：接收一个绑定在 loop 号事件循环上的 socket 和服务器级共享状态
+    Session(FrameStream::socket_type&& socket, std::size_t loop, ServerContext& ctx)
+        : ws_(std::move(socket)), loop_(loop), ctx_(ctx) {}
 
-    // 启动会话，设置选项并接受 WebSocket 握手
+    // 供 SessionRegistry 记录本会话所在的分片与槽位
+    RegistryHook& registry_hook() noexcept {
+        return registry_hook_;
+    }
+
+    // 启动会话：切换到所属事件循环的线程后再开始握手
     void run() {
-        // 设置超时选项，使用推荐的服务器角色超时配置
-        ws_.set_option(
-            websocket::stream_base::timeout::suggested(
-                beast::role_type::server));
+#if WEBSOCKET_COROUTINES
+        net::co_spawn(ws_.get_executor(), serve(shared_from_this()), net::detached);
+#else
+        net::dispatch(
+            ws_.get_executor(),
+            beast::bind_front_handler(
+                &Session::on_run,
+                shared_from_this()));
+#endif
+    }
+
+#if WEBSOCKET_COROUTINES
+    // 协程路径：HTTP 请求、握手与逐条读取消息在一个协程中顺序进行
+    // self 保存在协程帧中，整个会话只复制一次 shared_ptr，各步之间不再经由 shared_from_this()；
+    // 每步的操作状态同样从 handler_memory_ 分配。发送仍由 send 驱动的回调完成，两条路径相同
+    coro::Awaitable<> serve([[maybe_unused]] std::shared_ptr<Session> self) {
+        configure();
+        beast::error_code ec;
+
+        // 普通 HTTP 请求（keep-alive 时可能有多个），直到收到升级请求
+        for(;;) {
+            begin_request();
+            co_await http::async_read(ws_.next_layer(), buffer_, *parser_,
+                coro::use_memory(handler_memory_, ec));
+            if(ec) {
+                request_failed(ec);
+                co_return;
+            }
+            if(websocket::is_upgrade(parser_->get())) {
+                break;
+            }
+            auto const res = make_http_response(parser_->get());
+            co_await http::async_write(ws_.next_layer(), *res, coro::use_memory(handler_memory_, ec));
+            if(!http_written(*res, ec)) {
+                co_return;
+            }
+        }
+
+        co_await ws_.async_accept(parser_->get(), coro::use_memory(handler_memory_, ec));
+        if(!accepted(ec)) {
+            co_return;
+        }
+
+        for(;;) {
+            auto const n = co_await ws_.async_read_some(read_buffer(), coro::use_memory(handler_memory_, ec));
+            if(!handle_read(ec, n)) {
+                co_return;
+            }
+        }
+    }
+#endif
+
+    // 在所属事件循环上设置选项并读取第一个 HTTP 请求
+    void on_run() {
+        configure();
+        read_request();
+    }
+
+    // 设置流的选项
+    void configure() {
+        // io_uring 后端：本连接的读写改由所属事件循环的 io_uring 提交
+        if(!ctx_.urings.empty()) {
+            ws_.next_layer().use_uring(ctx_.urings[loop_].get());
+        }
+
+        // 握手期限、空闲超时与保活 ping 都由本循环的时间轮统一处理，不再为每个流启用 Beast 自己的定时器
+        ws_.set_option(websocket::stream_base::timeout{
+            websocket::stream_base::none(),
+            websocket::stream_base::none(),
+            false});
         
-        // 设置握手响应头装饰器，添加 Server 字段
+        // 按配置接受客户端的 permessage-deflate 请求（只影响协商与读取方向的解压）
+        ws_.set_option(deflate::beast_options(ctx_.config.deflate));
+
+        // 设置握手响应头装饰器，添加 Server 字段，并从协商结果中记下压缩窗口
         ws_.set_option(websocket::stream_base::decorator(
-            [](websocket::response_type& res) {
+            [this](websocket::response_type& res) {
                 res.set(http::field::server,
                     "WebSocket-Server");
+                deflate_window_ = deflate::negotiated_window_bits(res);
             }));
-        
-        // 异步接受握手，完成后调用 on_accept
+    }
+
+    // 读取一个 HTTP 请求
+    void read_request() {
+        begin_request();
+        http::async_read(
+            ws_.next_layer(),
+            buffer_,
+            *parser_,
+            bind_memory(handler_memory_, beast::bind_front_handler(
+                &Session::on_request,
+                shared_from_this())));
+    }
+
+    // 准备读取一个 HTTP 请求；从这里到握手完成（或应答写完）受握手期限限制
+    void begin_request() {
+        parser_.emplace();
+        auto& w = wheel();
+        if(auto const deadline = w.ticks(ctx_.config.handshake_timeout)) {
+            w.schedule(timer_, this, deadline);
+        }
+    }
+
+    // HTTP 请求读取完成：升级请求继续 WebSocket 握手，其余请求直接应答
+    void on_request(beast::error_code ec, std::size_t) {
+        if(ec) {
+            request_failed(ec);
+            return;
+        }
+
+        auto const& req = parser_->get();
+        if(!websocket::is_upgrade(req)) {
+            serve_http(req);
+            return;
+        }
+
+        // 用已读取的升级请求完成握手，完成后调用 on_accept
         ws_.async_accept(
-            beast::bind_front_handler(
+            req,
+            bind_memory(handler_memory_, beast::bind_front_handler(
                 &Session::on_accept,
-                shared_from_this()));
+                shared_from_this())));
+    }
+
+    // 读取 HTTP 请求失败，连接随之结束
+    void request_failed(beast::error_code ec) {
+        wheel().cancel(timer_);
+        // keep-alive 连接在两次请求之间正常关闭不算失败
+        if(!(served_http_ && ec == http::error::end_of_stream)) {
+            metrics::add(metrics::Counter::handshake_failures);
+            LOG_DEBUG << "读取 HTTP 请求失败: " << ec.message();
+        }
+    }
+
+    // 应答一个普通 HTTP 请求
+    void serve_http(http::request<http::empty_body> const& req) {
+        auto res = make_http_response(req);
+        http::async_write(
+            ws_.next_layer(),
+            *res,
+            bind_memory(handler_memory_, beast::bind_front_handler(
+                &Session::on_http_write,
+                shared_from_this(),
+                res)));
+    }
+
+    // 生成普通 HTTP 请求的应答：GET /metrics 返回指标，其他路径返回 404
+    std::shared_ptr<http::response<http::string_body>> make_http_response(
+        http::request<http::empty_body> const& req) {
+        metrics::add(metrics::Counter::http_requests);
+
+        auto res = std::make_shared<http::response<http::string_body>>();
+        res->version(req.version());
+        res->keep_alive(req.keep_alive());
+        res->set(http::field::server, "WebSocket-Server");
+        if(req.method() == http::verb::get && req.target() == "/metrics") {
+            res->result(http::status::ok);
+            res->set(http::field::content_type, "text/plain; version=0.0.4; charset=utf-8");
+            res->body() = metrics::Registry::instance().render();
+        } else {
+            res->result(http::status::not_found);
+            res->set(http::field::content_type, "text/plain; charset=utf-8");
+            res->body() = "Not Found\n";
+        }
+        res->prepare_payload();
+        return res;
+    }
+
+    // HTTP 应答写完的回调
+    void on_http_write(std::shared_ptr<http::response<http::string_body>> const& res,
+                       beast::error_code ec, std::size_t) {
+        if(http_written(*res, ec)) {
+            read_request();
+        }
+    }
+
+    // HTTP 应答写完：keep-alive 时返回 true 继续读下一个请求，否则关闭发送方向并返回 false
+    bool http_written(http::response<http::string_body> const& res, beast::error_code ec) {
+        served_http_ = true;
+        if(!ec && res.keep_alive()) {
+            return true;
+        }
+        wheel().cancel(timer_);
+        beast::get_lowest_layer(ws_).socket().shutdown(tcp::socket::shutdown_send, ec);
+        return false;
     }
 
     // 握手完成后的回调
     void on_accept(beast::error_code ec) {
+        if(accepted(ec)) {
+            read_message();
+        }
+    }
+
+    // 握手完成：成功时登记会话并加入默认房间，返回是否开始读取消息
+    bool accepted(beast::error_code ec) {
+        // 握手之后的读取不再经过 buffer_，释放其内存
+        parser_.reset();
+        buffer_ = beast::flat_buffer();
         if(ec) {
             // 握手错误时输出并返回
-            std::cerr << "握手失败，错误信息: " << ec.message() << std::endl;
-            return;
-        }
-        
-        // 将当前会话加入到全局集合，保护操作加锁
-        {
-            std::lock_guard<std::mutex> lock(sessions_mutex_);
-            sessions_.insert(shared_from_this());
-            std::cout << "新客户端连接，总客户端数: " << sessions_.size() << std::endl;
+            wheel().cancel(timer_);
+            metrics::add(metrics::Counter::handshake_failures);
+            LOG_WARN << "握手失败，错误信息: " << ec.message();
+            return false;
         }
         
-        // 开始读取消息
-        read_message();
+        // 将当前会话登记到所属事件循环的分组，只锁住所在的分片
+        auto const count = ctx_.sessions.insert(shared_from_this(), loop_);
+        metrics::add(metrics::Counter::connections_accepted);
+        LOG_INFO << "新客户端连接，总客户端数: " << count;
+
+        // 握手期限结束，开始空闲检查；收到的 pong 等控制帧同样算作活动
+        established_ = true;
+        ws_.control_callback([this](websocket::frame_type, beast::string_view) {
+            touch();
+        });
+        touch();
+        schedule_idle_check();
+
+        // 自动加入默认房间
+        join_room(default_room);
+        return true;
     }
 
-    // 异步读取消息
+    // 异步读取消息：负载直接读入帧缓冲区中帧头预留区之后的位置，
+    // 读完后原地补上帧头即可交给接收者，不再复制成 std::string 再编码
+    //
+    // 两条消息之间先以空缓冲区读取：Beast 读入帧头（并处理 ping/close 等控制帧）后返回 0 字节，
+    // 此时才向本循环的缓冲池借用缓冲区读取负载。空闲连接因此不持有任何接收缓冲区。
     void read_message() {
-        ws_.async_read(
-            buffer_,
-            beast::bind_front_handler(
+        ws_.async_read_some(
+            read_buffer(),
+            bind_memory(handler_memory_, beast::bind_front_handler(
                 &Session::on_read,
-                shared_from_this()));
+                shared_from_this())));
+    }
+
+    // 下一次读取的目标：两条消息之间为空缓冲区，消息读取中为借用的帧缓冲区的剩余部分
+    net::mutable_buffer read_buffer() {
+        if(!inbound_) {
+            // 长度为 0 但地址非空：Beast 的 UTF-8 校验会对地址做指针运算，不能传空指针
+            static char idle_read;
+            return net::mutable_buffer(&idle_read, 0);
+        }
+        if(inbound_->full()) {
+            // 超过当前级别容量的长消息：换成两倍大小的缓冲区继续读
+            inbound_ = inbound_->grow(inbound_->capacity() * 2);
+        }
+        return inbound_->prepare();
+    }
+
+    // 向缓冲池借用接收缓冲区
+    void borrow_inbound() {
+        inbound_ = FrameBuffer::create();
+        metrics::adjust(metrics::Gauge::read_buffers, 1);
+    }
+
+    // 消息读完或连接结束，归还接收缓冲区（已交给接收者的由最后一个引用归还）
+    void release_inbound() {
+        if(inbound_) {
+            inbound_.reset();
+            metrics::adjust(metrics::Gauge::read_buffers, -1);
+        }
     }
 
     // 读取完成后的回调
-    void on_read(beast::error_code ec, std::size_t) {
+    void on_read(beast::error_code ec, std::size_t bytes_transferred) {
+        if(handle_read(ec, bytes_transferred)) {
+            read_message();
+        }
+    }
+
+    // 处理一次读取的结果：消息读完时发布或执行命令，返回是否继续读取（连接结束时为 false）
+    bool handle_read(beast::error_code ec, std::size_t bytes_transferred) {
+        if(ec) {
+            wheel().cancel(timer_);
+            // 读取结束即连接结束；io_uring 上仍挂起的写入不会因 Beast 关闭描述符而结束，在这里取消
+            ws_.next_layer().cancel();
+        }
+
         if(ec == websocket::error::closed) {
-            // 如果客户端关闭连接，从集合中移除并返回
-            {
-                std::lock_guard<std::mutex> lock(sessions_mutex_);
-                sessions_.erase(shared_from_this());
-                std::cout << "客户端断开连接，总客户端数: " << sessions_.size() << std::endl;
-            }
-            return;
+            // 如果客户端关闭连接，退出全部房间、从注册表中移除并返回
+            leave_all_rooms();
+            auto const count = ctx_.sessions.erase(*this);
+            metrics::add(metrics::Counter::connections_closed);
+            LOG_INFO << "客户端断开连接，总客户端数: " << count;
+            release_inbound();
+            return false;
         }
         
         if(ec) {
-            // 其他读取错误时输出并返回
-            std::cerr << "读取错误: " << ec.message() << std::endl;
-            return;
+            // 其他读取错误时输出（主动断开的除外），同样退出房间并从注册表中移除，避免继续向失效连接广播
+            if(!closing_) {
+                LOG_WARN << "读取错误: " << ec.message();
+            }
+            release_inbound();
+            leave_all_rooms();
+            ctx_.sessions.erase(*this);
+            metrics::add(metrics::Counter::connections_closed);
+            return false;
         }
         
-        // 将缓冲区中的数据转换为字符串
-        auto out = beast::buffers_to_string(buffer_.data());
-        std::cout << "收到消息: " << out << std::endl;
-
-        // 广播消息给所有其他客户端
-        {
-            std::lock_guard<std::mutex> lock(sessions_mutex_);
-            for(auto& session : sessions_) {
-                if(session.get() != this) {
-                    session->ws_.async_write(
-                        net::buffer(out),
-                        [](beast::error_code ec, std::size_t bytes_transferred) {
-                            if(ec) {
-                                std::cerr << "写入错误: " << ec.message() << std::endl;
-                            }
-                        });
-                }
-            }
+        // 只记下时刻，不重新登记定时器：到期检查时再按最近的活动时刻推迟
+        touch();
+
+        if(!inbound_) {
+            // 新消息的数据已到达，借用缓冲区读取负载（空消息也需要一块缓冲区来封装帧）
+            borrow_inbound();
+        }
+        inbound_->commit(bytes_transferred);
+        if(!ws_.is_message_done()) {
+            // 消息尚未读完（分片或超过缓冲区容量），继续读取
+            return true;
+        }
+
+        auto const payload = inbound_->payload();
+
+        // 追踪模式下从读取完成开始计时
+        std::shared_ptr<tracing::MessageTrace> trace;
+        if(ctx_.config.trace) {
+            trace = std::make_shared<tracing::MessageTrace>(
+                tracing::clock::now(), ctx_.config.trace_threshold, payload.size());
+        }
+
+        metrics::add(metrics::Counter::messages_received);
+        metrics::add(metrics::Counter::bytes_received, payload.size());
+        // 逐消息日志按 --log-sample 采样，写入本线程的日志环后立即返回
+        LOG_SAMPLED << "收到消息: " << payload;
+
+        if(ws_.got_text() && !payload.empty() && payload[0] == '/') {
+            // 房间控制命令
+            handle_command(std::string(payload));
+        } else {
+            publish(trace);
         }
         
-        // 清空缓冲区并继续读取下一条消息
-        buffer_.consume(buffer_.size());
-        read_message();
+        // 缓冲区已交给接收者（或不再需要），下一条消息到达时再借用
+        release_inbound();
+        return true;
+    }
+
+    // 将一条已编码的共享帧加入发送队列，队列超限时按配置的背压策略处理
+    // 只能在本会话所属事件循环的线程上调用，由 FanOut 保证
+    void send(FrameRef const& frame,
+              std::shared_ptr<tracing::MessageTrace> const& trace = nullptr) {
+        if(closing_) {
+            return;
+        }
+
+        // 协商了压缩且窗口不小于压缩时所用窗口的接收者，改发共享的压缩帧
+        auto const& deflated = frame->deflated();
+        auto const& out = deflated && deflate_window_ >= ctx_.config.deflate.server_window_bits ? deflated : frame;
+
+        if(queue_.push(out, ctx_.config.queue, trace) == OutboundQueue::Result::overflow) {
+            disconnect_slow_consumer();
+            return;
+        }
+
+        // 已有写操作在进行时只排队，保证同一个流上只有一个写操作
+        if(!queue_.writing() && queue_.has_pending()) {
+            write_next();
+        }
+    }
+
+private:
+    // 把刚读完的消息发布到当前房间；trace 非空时记录扇出各阶段的耗时
+    void publish(std::shared_ptr<tracing::MessageTrace> const& trace) {
+        if(!current_) {
+            reply("尚未加入任何房间，请先使用 /join <房间名>");
+            return;
+        }
+
+        // 在负载之前原地写入服务端帧头，所有接收者共用这一块缓冲区
+        auto const op = ws_.got_text() ? frame::opcode::text : frame::opcode::binary;
+        inbound_->seal(op);
+
+        // 启用压缩时整条消息只压缩一次，压缩帧挂在原帧上，由各接收者在 send 中选用
+        auto const& deflate_options = ctx_.config.deflate;
+        if(deflate_options.enabled && inbound_->payload().size() >= deflate_options.min_size) {
+            inbound_->set_deflated(deflate::compress(op, inbound_->payload(), deflate_options));
+        }
+        FrameRef const out = inbound_;
+
+        // 只发给房间内的其他成员：本循环直接发送，其余循环各投递一个任务
+        auto const start = std::chrono::steady_clock::now();
+        if(trace) {
+            trace->fanout_started();
+        }
+        if(ctx_.mesh) {
+            // 无共享模式：本核心的成员直接发送，其余每个核心各推入一条通道消息
+            ctx_.mesh->publish(loop_, current_->id, out, this, trace);
+        } else {
+            ctx_.fanout.publish(
+                std::shared_ptr<SessionRegistry<Session> const>(
+                    current_->room, &current_->room->members()),
+                loop_, out, shared_from_this(), trace);
+        }
+        metrics::observe(metrics::Hist::fanout_ns, static_cast<std::uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now() - start).count()));
+    }
+
+    // 解析并执行一条房间控制命令，格式为 "/命令 参数"
+    void handle_command(std::string const& line) {
+        auto const space = line.find(' ');
+        auto const command = line.substr(0, space);
+        auto const argument = space == std::string::npos ? std::string() : line.substr(space + 1);
+
+        if(command != "/join" && command != "/leave") {
+            reply("未知命令: " + command + "，可用命令: /join <房间名>、/leave <房间名>");
+            return;
+        }
+        if(!valid_room_name(argument)) {
+            reply("房间名需为 1-64 个字符且不含空白");
+            return;
+        }
+
+        if(command == "/join") {
+            join_room(argument);
+            reply("已加入房间 " + argument);
+        } else if(leave_room(argument)) {
+            reply("已离开房间 " + argument);
+        } else {
+            reply("不在房间 " + argument + " 中");
+        }
+    }
+
+    static bool valid_room_name(std::string const& name) {
+        if(name.empty() || name.size() > 64) {
+            return false;
+        }
+        for(char c : name) {
+            if(c == ' ' || c == '\t' || c == '\r' || c == '\n') {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // 加入房间（已在房间中则只切换当前房间）
+    void join_room(std::string const& name) {
+        auto it = rooms_.find(name);
+        if(it == rooms_.end()) {
+            it = rooms_.emplace(name, Membership{}).first;
+            if(ctx_.mesh) {
+                it->second.id = ctx_.mesh->join(loop_, name, this, it->second.hook);
+            } else {
+                it->second.room = ctx_.rooms.join(name, shared_from_this(), it->second.hook, loop_);
+            }
+        }
+        current_ = &it->second;
+    }
+
+    // 离开房间，返回是否确实在该房间中
+    bool leave_room(std::string const& name) {
+        auto it = rooms_.find(name);
+        if(it == rooms_.end()) {
+            return false;
+        }
+        if(current_ == &it->second) {
+            current_ = nullptr;
+        }
+        leave(it->first, it->second);
+        rooms_.erase(it);
+        return true;
+    }
+
+    // 断开连接时离开全部房间
+    void leave_all_rooms() {
+        current_ = nullptr;
+        for(auto& entry : rooms_) {
+            leave(entry.first, entry.second);
+        }
+        rooms_.clear();
+    }
+
+    // 注销一个房间中的成员资格
+    void leave(std::string const& name, Membership& membership) {
+        if(ctx_.mesh) {
+            ctx_.mesh->leave(loop_, name, membership.id, membership.hook);
+        } else {
+            ctx_.rooms.leave(*membership.room, membership.hook);
+        }
+    }
+
+    // 向本会话自己发送一条系统消息
+    void reply(std::string const& text) {
+        send(FrameBuffer::make(frame::opcode::text, "[系统] " + text));
+    }
+
+    // 本会话所属事件循环的时间轮
+    TimerWheel<Session>& wheel() const noexcept {
+        return *ctx_.timers[loop_];
+    }
+
+    // 记录一次来自客户端的活动
+    void touch() noexcept {
+        last_activity_ = wheel().now();
+        ping_sent_ = false;
+    }
+
+    // 按最近的活动时刻登记下一次检查：尚未 ping 时为发出 ping 的时刻；
+    // 已经 ping 过时再隔一个 ping 间隔检查一次（期间收到 pong 就按新的活动时刻继续），但不晚于空闲超时的时刻
+    void schedule_idle_check() {
+        auto& w = wheel();
+        auto const idle_limit = w.ticks(ctx_.config.idle_timeout);
+        auto const ping_after = w.ticks(ctx_.config.ping_interval);
+
+        std::uint64_t next = 0;
+        if(ping_after) {
+            next = (ping_sent_ ? w.now() : last_activity_) + ping_after;
+        }
+        if(idle_limit && (next == 0 || last_activity_ + idle_limit < next)) {
+            next = last_activity_ + idle_limit;
+        }
+        if(next != 0) {
+            w.schedule_at(timer_, this, next);
+        }
+    }
+
+public:
+    // 时间轮回调：握手超时则关闭连接；否则按空闲时长发出 ping 或断开，仍然活跃时推迟到下一次检查
+    void on_timer() {
+        beast::error_code ec;
+        auto& socket = beast::get_lowest_layer(ws_).socket();
+        if(!established_) {
+            metrics::add(metrics::Counter::handshake_timeouts);
+            LOG_DEBUG << "握手超时，关闭连接 " << socket.remote_endpoint(ec);
+            // 挂起的 HTTP 读写或握手随之以错误结束
+            ws_.next_layer().close(ec);
+            return;
+        }
+
+        auto& w = wheel();
+        auto const idle = w.now() - last_activity_;
+        auto const idle_limit = w.ticks(ctx_.config.idle_timeout);
+        if(idle_limit && idle >= idle_limit) {
+            closing_ = true;
+            metrics::add(metrics::Counter::idle_timeouts);
+            LOG_INFO << "客户端 " << socket.remote_endpoint(ec) << " 空闲超时，断开连接";
+            // 与慢消费者一样直接关闭，挂起的读操作以错误结束，由 on_read 完成清理
+            ws_.next_layer().close(ec);
+            return;
+        }
+
+        auto const ping_after = w.ticks(ctx_.config.ping_interval);
+        if(ping_after && idle >= ping_after && !ping_sent_) {
+            // ping 与广播帧一样经发送队列写出，客户端的 pong 由 control_callback 记为活动
+            ping_sent_ = true;
+            metrics::add(metrics::Counter::pings_sent);
+            send(FrameBuffer::make(frame::opcode::ping, {}));
+        }
+        schedule_idle_check();
+    }
+
+private:
+    // 发送队列超出上限且策略为断开：直接关闭 socket，不再尝试向滞后的客户端写关闭帧
+    // 挂起的读操作随之以错误结束，由 on_read 完成退出房间与注销
+    void disconnect_slow_consumer() {
+        closing_ = true;
+
+        beast::error_code ec;
+        auto const endpoint = beast::get_lowest_layer(ws_).socket().remote_endpoint(ec);
+        LOG_WARN << "慢消费者 " << endpoint << " 发送队列积压 " << queue_.size() << " 条 / "
+                 << queue_.bytes() << " 字节，断开连接";
+
+        // 正在写入的帧仍被写操作引用，队列留给 on_write 在写操作结束后清理
+        ws_.next_layer().close(ec);
+    }
+
+    // 把当前全部待发送帧（受 max_flush_bytes 约束）合并为一次聚集写，
+    // 帧字节原样写入 tcp_stream，不再经过 Beast 的逐连接组帧
+    void write_next() {
+        ws_.next_layer().async_write_frames(
+            queue_.begin_write(ctx_.config.max_flush_bytes),
+            bind_memory(handler_memory_, beast::bind_front_handler(
+                &Session::on_write,
+                shared_from_this())));
+    }
+
+    // 写入完成后的回调
+    void on_write(beast::error_code ec, std::size_t bytes_transferred) {
+        if(ec) {
+            // 写入失败时丢弃剩余消息，连接的关闭由读取端处理
+            if(!closing_) {
+                LOG_WARN << "写入错误: " << ec.message();
+            }
+            queue_.clear();
+            return;
+        }
+
+        // 移除已发送的消息，继续发送写入期间新排队的消息
+        metrics::add(metrics::Counter::messages_sent, queue_.complete_write());
+        metrics::add(metrics::Counter::bytes_sent, bytes_transferred);
+        if(queue_.has_pending()) {
+            write_next();
+        }
     }
 };
 
 // 服务器类，负责监听端口并接受连接
 class Server {
-    net::io_context ioc_;                             // I/O 上下文，用于管理异步操作
-    tcp::acceptor acceptor_;                         // TCP 接受器，用于监听新连接
-    std::set<std::shared_ptr<Session>> sessions_;     // 存储所有会话
-    std::mutex sessions_mutex_;                      // 保护 sessions_ 的互斥量
+    // 与会话的流一样使用 io_context 的具体执行器
+    using Acceptor = net::basic_socket_acceptor<tcp, net::io_context::executor_type>;
+
+    // 全局注册表与房间成员表每个事件循环分组内的分片数，减小连接、断开时写时复制的快照大小
+    static constexpr std::size_t shards_per_loop = 4;
+
+    // slab 中每个块的大小：会话对象加上 allocate_shared 放在同一块里的控制块，由实际的控制块类型测得
+    static inline std::size_t const session_block_size = shared_block_size<Session>();
+
+    ServerConfig config_;                            // 服务器配置
+    std::vector<std::unique_ptr<Slab>> slabs_;       // 每个事件循环一个会话 slab，比全部会话与事件循环都活得久
+    std::atomic<bool> slab_oversize_logged_{false};  // 已提示过会话超过 slab 块大小
+    std::vector<std::unique_ptr<TimerWheel<Session>>> timers_;  // 每个事件循环一个时间轮；会话在每条结束路径上取消自己的定时器
+    IoContextPool pool_;                             // 事件循环池，每个线程一个 io_context
+    std::vector<std::unique_ptr<uring::Loop>> urings_;  // io_uring 后端时每个事件循环一个，先于事件循环池析构
+    std::vector<Acceptor> acceptors_;                // TCP 接受器：默认只有 0 号循环上的一个，SO_REUSEPORT 模式下每个循环一个
+    std::vector<FrameStream::socket_type> peers_;    // 每个接受器正在接受的连接，绑定在目标事件循环上
+    std::unique_ptr<HandlerMemory[]> accept_memory_; // 每个接受器异步接受操作的处理器内存
+
+    // io_uring 后端的接受请求：内核支持时提交一次，之后每个新连接产生一个完成
+    class UringAccept final : public uring::Operation {
+        Server& server_;
+        std::size_t index_;                          // 接受器下标
+        tcp const protocol_;                         // 接受器的协议，接受到的 socket 与之相同
+
+    public:
+        UringAccept(Server& server, std::size_t index)
+            : server_(server), index_(index),
+              protocol_(server.acceptors_[index].local_endpoint().protocol()) {}
+
+        tcp protocol() const noexcept {
+            return protocol_;
+        }
+
+        // 向接受器所在事件循环的 io_uring 提交
+        void arm() {
+            server_.urings_[index_]->accept(server_.acceptors_[index_].native_handle(), this);
+        }
+
+        void complete(int result, unsigned flags) override {
+            server_.on_uring_accept(index_, result, flags);
+        }
+    };
+    std::vector<std::unique_ptr<UringAccept>> uring_accepts_;  // io_uring 后端时每个接受器一个
+    SessionRegistry<Session> sessions_;              // 存储所有会话的注册表，按事件循环分组
+    RoomIndex<Session> rooms_;                       // 房间索引，房间成员同样按事件循环分组
+    FanOut<Session> fanout_;                         // 跨事件循环的广播
+    std::unique_ptr<CoreMesh<Session>> mesh_;        // 无共享模式下核心之间的消息网格
+    ServerContext context_;                          // 传给每个会话的共享状态
+    std::vector<net::steady_timer> tick_timers_;     // 每个事件循环推进时间轮的定时器
+    std::chrono::steady_clock::time_point epoch_;    // 时间轮第 0 个 tick 的时刻
+    net::steady_timer stats_timer_;                  // 定时输出背压统计
+    std::uint64_t last_shed_ = 0;                    // 上次输出时的丢弃与断开总数
 
 public:
-    // 构造函数：在指定端口创建接受器并启动接受连接流程
-    Server(unsigned short port)
-        : acceptor_(ioc_, {tcp::v4(), port}) {
-        accept_connection();
+    // 构造函数：按配置创建事件循环池，在指定端口创建接受器并启动接受连接流程
+    explicit Server(ServerConfig const& config)
+        : config_(config),
+          slabs_(make_slabs(config)),
+          timers_(make_timers(config)),
+          pool_(config.threads),
+          urings_(make_urings()),
+          sessions_(pool_.size(), shards_per_loop),
+          rooms_(pool_.size(), shards_per_loop),
+          fanout_(pool_),
+          mesh_(config.shared_nothing ? std::make_unique<CoreMesh<Session>>(pool_, config.core_ring_size) : nullptr),
+          context_{config_, sessions_, rooms_, fanout_, mesh_.get(), timers_, urings_},
+          stats_timer_(pool_.get(0)) {
+        // SO_REUSEPORT 模式下每个事件循环绑定自己的接受器，由内核在它们之间分配新连接
+        auto const count = config_.reuse_port ? pool_.size() : 1;
+        acceptors_.reserve(count);
+        peers_.reserve(count);
+        accept_memory_.reset(new HandlerMemory[count]);
+        for(std::size_t i = 0; i < count; ++i) {
+            acceptors_.push_back(make_acceptor(pool_.get(i), config_.port, config_.reuse_port,
+                                               config_.reuse_port ? cpu_of(i) : -1));
+            peers_.emplace_back(pool_.get(i));
+        }
+        // 每个循环启动后先在自己的线程上完成绑定与预热，之后才处理连接
+        for(std::size_t i = 0; i < pool_.size(); ++i) {
+            net::post(pool_.get(i), [this, i] { prepare_loop(i); });
+        }
+        for(std::size_t i = 0; i < count; ++i) {
+            if(urings_.empty()) {
+                accept_connection(i);
+            } else {
+                uring_accepts_.push_back(std::make_unique<UringAccept>(*this, i));
+                uring_accepts_.back()->arm();
+            }
+        }
+        epoch_ = std::chrono::steady_clock::now();
+        tick_timers_.reserve(pool_.size());
+        for(std::size_t i = 0; i < pool_.size(); ++i) {
+            tick_timers_.emplace_back(pool_.get(i));
+            schedule_tick(i);
+        }
+        schedule_stats();
+
+        // 不按线程统计的指标在采集时直接读取
+        auto& registry = metrics::Registry::instance();
+        registry.add_callback("websocket_connections", "当前在线的 WebSocket 连接数",
+            [this] { return static_cast<double>(sessions_.size()); });
+        registry.add_callback("websocket_rooms", "当前非空的房间数",
+            [this] { return static_cast<double>(mesh_ ? mesh_->room_count() : rooms_.size()); });
+        registry.add_callback("websocket_session_slab_blocks", "会话 slab 已申请的块数（含空闲块）",
+            [this] {
+                std::size_t blocks = 0;
+                for(auto const& slab : slabs_) {
+                    blocks += slab->capacity();
+                }
+                return static_cast<double>(blocks);
+            });
+        registry.add_callback("websocket_session_slab_oversized", "超过 slab 块大小、退回堆分配的会话数（应为 0）",
+            [this] {
+                std::size_t oversized = 0;
+                for(auto const& slab : slabs_) {
+                    oversized += slab->oversized();
+                }
+                return static_cast<double>(oversized);
+            });
+    }
+
+    ~Server() {
+        metrics::Registry::instance().clear_callbacks();
     }
 
-    // 运行服务器事件循环
+    // 运行服务器事件循环，阻塞直到全部循环退出
     void run() {
-        std::cout << "WebSocket server listening on port 8080\n";
-        ioc_.run();
+        LOG_INFO << "WebSocket server listening on port " << config_.port
+                 << "，事件循环线程数: " << pool_.size()
+                 << "，接受器数: " << acceptors_.size()
+                 << "，I/O 后端: " << (urings_.empty() ? "epoll" : "io_uring")
+                 << (mesh_ ? "，无共享模式" : "");
+        pool_.run();
     }
 
 private:
-    // 异步接受连接，并为每个新连接创建一个 Session
-    void accept_connection() {
-        acceptor_.async_accept(
-            [this](beast::error_code ec, tcp::socket socket) {
+    // 第 loop 个事件循环的时间轮在下一个 tick 的时刻推进；按起点计算时刻而不是逐次累加间隔，不会漂移，
+    // 事件循环一时繁忙错过的 tick 在下一次唤醒时一并补上
+    void schedule_tick(std::size_t loop) {
+        auto& wheel = *timers_[loop];
+        auto& timer = tick_timers_[loop];
+        timer.expires_at(epoch_ + wheel.tick() * (wheel.now() + 1));
+        timer.async_wait([this, loop](beast::error_code ec) {
+            if(ec) {
+                return;
+            }
+            auto& wheel = *timers_[loop];
+            auto const elapsed = std::chrono::steady_clock::now() - epoch_;
+            wheel.advance(static_cast<std::uint64_t>(elapsed / wheel.tick()));
+            schedule_tick(loop);
+        });
+    }
+
+    // 定时在 0 号事件循环上输出背压统计，只在计数发生变化时输出
+    void schedule_stats() {
+        if(config_.stats_interval.count() == 0) {
+            return;
+        }
+        stats_timer_.expires_after(config_.stats_interval);
+        stats_timer_.async_wait([this](beast::error_code ec) {
+            if(ec) {
+                return;
+            }
+            auto const c = metrics::Registry::instance().snapshot();
+            auto const oldest = c[metrics::Counter::dropped_oldest];
+            auto const newest = c[metrics::Counter::dropped_newest];
+            auto const conflated = c[metrics::Counter::conflated];
+            auto const disconnected = c[metrics::Counter::slow_disconnects];
+            auto const total = oldest + newest + conflated + disconnected;
+            if(total != last_shed_) {
+                last_shed_ = total;
+                LOG_INFO << "背压统计: drop-oldest " << oldest
+                         << "，drop-newest " << newest
+                         << "，conflate " << conflated
+                         << "，disconnect " << disconnected
+                         << "，丢弃字节 " << c[metrics::Counter::dropped_bytes]
+                         << "，在线客户端 " << sessions_.size();
+            }
+            schedule_stats();
+        });
+    }
+
+    // 创建并监听接受器；设为非阻塞，以便在一次唤醒中连续接受多个连接
+    static Acceptor make_acceptor(net::io_context& ioc, unsigned short port, bool reuse_port, int cpu) {
+        tcp::endpoint const endpoint(tcp::v4(), port);
+        Acceptor acceptor(ioc);
+        acceptor.open(endpoint.protocol());
+        acceptor.set_option(net::socket_base::reuse_address(true));
+        if(reuse_port) {
+#ifdef SO_REUSEPORT
+            using reuse_port_option = net::detail::socket_option::boolean<SOL_SOCKET, SO_REUSEPORT>;
+            acceptor.set_option(reuse_port_option(true));
+#else
+            throw std::runtime_error("当前平台不支持 SO_REUSEPORT");
+#endif
+        }
+        // 同一 SO_REUSEPORT 组中，内核优先把在 cpu 上收到的连接交给这个接受器
+        if(cpu >= 0 && !affinity::set_incoming_cpu(acceptor.native_handle(), cpu)) {
+            LOG_WARN << "无法为接受器设置 SO_INCOMING_CPU=" << cpu;
+        }
+        acceptor.bind(endpoint);
+        acceptor.listen(net::socket_base::max_listen_connections);
+        acceptor.non_blocking(true);
+        return acceptor;
+    }
+
+    // 新连接绑定到的事件循环：SO_REUSEPORT 模式下留在接受它的循环，否则轮询分配
+    std::size_t target_loop(std::size_t acceptor_index) {
+        return config_.reuse_port ? acceptor_index : pool_.next();
+    }
+
+    // --io-backend=io_uring 时为每个事件循环创建 io_uring；任何一个创建失败都整体退回 epoll
+    std::vector<std::unique_ptr<uring::Loop>> make_urings() {
+        std::vector<std::unique_ptr<uring::Loop>> urings;
+        if(config_.io_backend != IoBackend::io_uring) {
+            return urings;
+        }
+        for(std::size_t i = 0; i < pool_.size(); ++i) {
+            std::string error;
+            auto ring = uring::Loop::create(pool_.get(i), config_.uring_entries, error);
+            if(!ring) {
+                LOG_WARN << "io_uring 不可用（" << error << "），改用 epoll";
+                urings.clear();
+                return urings;
+            }
+            if(!ring->multishot_accept() && urings.empty()) {
+                LOG_INFO << "内核不支持 io_uring 多次接受（需要 5.19 以上），每个连接单独提交接受请求";
+            }
+            urings.push_back(std::move(ring));
+        }
+        for(auto& ring : urings) {
+            ring->start();
+        }
+        return urings;
+    }
+
+    // 第 loop 个事件循环绑定的 CPU，未配置 --cpus 时返回 -1
+    int cpu_of(std::size_t loop) const {
+        return config_.cpus.empty() ? -1 : config_.cpus[loop % config_.cpus.size()];
+    }
+
+    // 绑定在 cpu 上的事件循环，没有时返回 pool_.size()
+    std::size_t loop_on_cpu(int cpu) const {
+        for(std::size_t loop = 0; cpu >= 0 && loop < pool_.size(); ++loop) {
+            if(cpu_of(loop) == cpu) {
+                return loop;
+            }
+        }
+        return pool_.size();
+    }
+
+    // 在第 loop 个事件循环的线程上执行一次：绑定 CPU、登记 NUMA 节点，再预热会话 slab，
+    // 使 slab 与缓冲池的内存都由绑定后的线程首次写入，分配在本地节点上
+    void prepare_loop(std::size_t loop) {
+        auto const cpu = cpu_of(loop);
+        if(cpu >= 0) {
+            if(affinity::pin_current_thread(cpu)) {
+                auto const node = affinity::numa_node(cpu);
+                FrameBuffer::set_thread_node(node);
+                LOG_INFO << "事件循环 " << loop << " 绑定到 CPU " << cpu << "（NUMA 节点 " << node << "）";
+            } else {
+                LOG_WARN << "事件循环 " << loop << " 无法绑定到 CPU " << cpu;
+            }
+        }
+        auto const loops = pool_.size();
+        slabs_[loop]->reserve((config_.session_prealloc + loops - 1) / loops);
+    }
+
+    // 每个事件循环一个会话 slab，由 prepare_loop 在所属线程上按 --session-prealloc 预热（分摊到各循环）
+    static std::vector<std::unique_ptr<Slab>> make_slabs(ServerConfig const& config) {
+        auto const loops = config.threads > 0 ? config.threads : 1;
+        std::vector<std::unique_ptr<Slab>> slabs;
+        slabs.reserve(loops);
+        for(std::size_t i = 0; i < loops; ++i) {
+            slabs.push_back(std::make_unique<Slab>(session_block_size));
+        }
+        return slabs;
+    }
+
+    // 每个事件循环一个时间轮
+    static std::vector<std::unique_ptr<TimerWheel<Session>>> make_timers(ServerConfig const& config) {
+        auto const loops = config.threads > 0 ? config.threads : 1;
+        std::vector<std::unique_ptr<TimerWheel<Session>>> timers;
+        timers.reserve(loops);
+        for(std::size_t i = 0; i < loops; ++i) {
+            timers.push_back(std::make_unique<TimerWheel<Session>>(config.timer_tick));
+        }
+        return timers;
+    }
+
+    // 为新连接创建 Session 并启动握手；会话与控制块从目标循环的 slab 分配，
+    // 同一循环的会话在内存中相邻，断开后的块留给后来的连接
+    void start_session(FrameStream::socket_type socket, std::size_t loop) {
+        loop = steer(socket, loop);
+        std::allocate_shared<Session>(
+            SlabAllocator<Session>(*slabs_[loop]), std::move(socket), loop, context_)->run();
+        // 块大小由实际的控制块类型测得，不应超出；一旦超出只提示一次，之后见 websocket_session_slab_oversized
+        if(slabs_[loop]->oversized() != 0 && !slab_oversize_logged_.exchange(true, std::memory_order_relaxed)) {
+            LOG_WARN << "会话超过 slab 块大小（" << slabs_[loop]->block_size() << " 字节），改用堆分配";
+        }
+    }
+
+    // io_uring 接受到一个连接（result 为新 socket）或出错；请求结束（没有后续完成）时重新提交。
+    // 只有连接被对端放弃、描述符或内存暂时耗尽等错误才重新提交，其他错误说明该接受器无法经由
+    // io_uring 接受连接，改回 Asio 接受，避免反复提交注定失败的请求
+    void on_uring_accept(std::size_t index, int result, unsigned flags) {
+        if(result >= 0) {
+            auto const loop = target_loop(index);
+            FrameStream::socket_type socket(pool_.get(loop));
+            beast::error_code ec;
+            socket.assign(uring_accepts_[index]->protocol(), result, ec);
+            if(ec) {
+                LOG_WARN << "接受连接失败，错误信息: " << ec.message();
+                ::close(result);
+            } else {
+                start_session(std::move(socket), loop);
+            }
+        } else if(result == -ECANCELED) {
+            return;
+        } else {
+            LOG_WARN << "接受连接失败，错误信息: "
+                     << beast::error_code(-result, boost::system::system_category()).message();
+            if(!transient_accept_error(-result)) {
+                LOG_WARN << "接受器 " << index << " 改用 epoll 接受连接";
+                accept_connection(index);
+                return;
+            }
+        }
+        if(!uring::Loop::more(flags)) {
+            uring_accepts_[index]->arm();
+        }
+    }
+
+    // 重新接受即可恢复的错误
+    static bool transient_accept_error(int error) {
+        switch(error) {
+        case EAGAIN:
+        case EINTR:
+        case ECONNABORTED:
+        case EPROTO:
+        case EPERM:
+        case EMFILE:
+        case ENFILE:
+        case ENOBUFS:
+        case ENOMEM:
+            return true;
+        default:
+            return false;
+        }
+    }
+
+    // 只有一个接受器且绑定了 CPU 时，把连接改派到绑定在它的接收 CPU（网卡接收队列中断所在核心）上的事件循环，
+    // 连接的收包、协议处理与写出都留在同一个核心；SO_REUSEPORT 模式由监听 socket 的 SO_INCOMING_CPU 完成同样的引导
+    std::size_t steer(FrameStream::socket_type& socket, std::size_t loop) {
+        if(config_.cpus.empty() || config_.reuse_port) {
+            return loop;
+        }
+        auto const target = loop_on_cpu(affinity::incoming_cpu(socket.native_handle()));
+        if(target == pool_.size() || target == loop) {
+            return loop;
+        }
+        beast::error_code ec;
+        auto const protocol = socket.local_endpoint(ec).protocol();
+        if(ec) {
+            return loop;
+        }
+        auto const fd = socket.release(ec);
+        if(ec) {
+            return loop;
+        }
+        FrameStream::socket_type moved(pool_.get(target));
+        moved.assign(protocol, fd, ec);
+        if(ec) {
+            LOG_WARN << "改派连接失败，错误信息: " << ec.message();
+            ::close(fd);
+            return loop;
+        }
+        socket = std::move(moved);
+        metrics::add(metrics::Counter::connections_steered);
+        return target;
+    }
+
+#if WEBSOCKET_COROUTINES
+    // 在第 index 个接受器上启动接受连接的协程
+    void accept_connection(std::size_t index) {
+        net::co_spawn(acceptors_[index].get_executor(), accept_loop(index), net::detached);
+    }
+
+    // 循环接受连接：每接受一个连接创建会话，并顺带取走监听队列中已就绪的连接
+    coro::Awaitable<> accept_loop(std::size_t index) {
+        beast::error_code ec;
+        for(;;) {
+            auto const loop = target_loop(index);
+            peers_[index] = FrameStream::socket_type(pool_.get(loop));
+            co_await acceptors_[index].async_accept(peers_[index], coro::use_memory(accept_memory_[index], ec));
+            if(!ec) {
+                start_session(std::move(peers_[index]), loop);
+                accept_batch(index);
+            } else {
+                LOG_WARN << "接受连接失败，错误信息: " << ec.message();
+            }
+        }
+    }
+#else
+    // 在第 index 个接受器上异步接受连接
+    void accept_connection(std::size_t index) {
+        auto const loop = target_loop(index);
+        peers_[index] = FrameStream::socket_type(pool_.get(loop));
+        acceptors_[index].async_accept(
+            peers_[index],
+            bind_memory(accept_memory_[index], [this, index, loop](beast::error_code ec) {
                 if(!ec) {
-                    std::make_shared<Session>(std::move(socket), sessions_, sessions_mutex_)->run();
+                    start_session(std::move(peers_[index]), loop);
+                    // 连接风暴时监听队列里往往还有更多连接，一并取走
+                    accept_batch(index);
                 } else {
-                    std::cerr << "握手失败，错误信息: " << ec.message() << std::endl;
+                    LOG_WARN << "接受连接失败，错误信息: " << ec.message();
                 }
                 // 继续接受下一次连接
-                accept_connection();
-            });
+                accept_connection(index);
+            }));
+    }
+#endif
+
+    // 以非阻塞方式继续接受监听队列中已就绪的连接，直到队列为空或达到批量上限
+    void accept_batch(std::size_t index) {
+        for(std::size_t i = 1; i < config_.accept_batch; ++i) {
+            auto const loop = target_loop(index);
+            beast::error_code ec;
+            FrameStream::socket_type socket(pool_.get(loop));
+            acceptors_[index].accept(socket, ec);
+            if(ec) {
+                // would_block 表示队列已空，其他错误留给下一次异步接受处理
+                break;
+            }
+            start_session(std::move(socket), loop);
+        }
     }
 };
 
 // 程序入口点
-int main() {
+int main(int argc, char** argv) {
+    ServerConfig config;
     try {
-        Server server(8080);  // 在 8080 端口启动服务器
-        server.run();         // 运行 I/O 循环
+        config = parse_config(argc, argv);  // 解析命令行参数
     } catch (const std::exception& e) {
-        // 捕获并输出任何异常
-        std::cerr << "Fatal error: " << e.what() << std::endl;
+        std::cerr << e.what() << "\n" << server_usage();
         return EXIT_FAILURE;
     }
-    return EXIT_SUCCESS;
+
+    // 启动后台日志线程，事件循环线程只把日志写入各自的环
+    auto& logger = logging::Logger::instance();
+    logger.set_level(config.log_level);
+    logger.set_sample(config.log_sample);
+    logger.start();
+
+    // 接收缓冲区池的保留上限对全部事件循环生效
+    FrameBuffer::set_retained_limit(config.buffer_pool_bytes);
+
+    int status = EXIT_SUCCESS;
+    try {
+        Server server(config);  // 按配置启动服务器
+        server.run();           // 运行全部事件循环
+    } catch (const std::exception& e) {
+        // 捕获并输出任何异常
+        LOG_ERROR << "Fatal error: " << e.what();
+        status = EXIT_FAILURE;
+    }
+
+    // 退出前输出全部剩余日志
+    logger.stop();
+    return status;
 }